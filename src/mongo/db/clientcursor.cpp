@@ -106,7 +106,7 @@ ClientCursor::ClientCursor(ClientCursorParams params,
 
 ClientCursor::~ClientCursor() {
     // Cursors must be unpinned and deregistered from their cursor manager before being deleted.
-    invariant(!_isPinned);
+    invariant(!_isPinned.load());
     invariant(_disposed);
 
     cursorStatsOpen.decrement();
@@ -152,7 +152,7 @@ void ClientCursor::updateSlaveLocation(OperationContext* opCtx) {
 ClientCursorPin::ClientCursorPin(OperationContext* opCtx, ClientCursor* cursor)
     : _opCtx(opCtx), _cursor(cursor) {
     invariant(_cursor);
-    invariant(_cursor->_isPinned);
+    invariant(_cursor->_isPinned.load());
     invariant(_cursor->_cursorManager);
     invariant(!_cursor->_disposed);
 
@@ -168,7 +168,7 @@ ClientCursorPin::ClientCursorPin(ClientCursorPin&& other)
     // The pinned cursor is being transferred to us from another pin. The 'other' pin must have a
     // pinned cursor.
     invariant(other._cursor);
-    invariant(other._cursor->_isPinned);
+    invariant(other._cursor->_isPinned.load());
 
     // Be sure to set the 'other' pin's cursor to null in order to transfer ownership to ourself.
     other._cursor = nullptr;
@@ -184,7 +184,7 @@ ClientCursorPin& ClientCursorPin::operator=(ClientCursorPin&& other) {
     // pinned cursor, and we must not have a cursor.
     invariant(!_cursor);
     invariant(other._cursor);
-    invariant(other._cursor->_isPinned);
+    invariant(other._cursor->_isPinned.load());
 
     // Copy the cursor pointer to ourselves, but also be sure to set the 'other' pin's cursor to
     // null so that it no longer has the cursor pinned.
@@ -213,14 +213,14 @@ void ClientCursorPin::release() {
         _opCtx->lockState()->isCollectionLockedForMode(_cursor->_nss.ns(), MODE_IS);
     dassert(isLocked || _cursor->_cursorManager->isGlobalManager());
 
-    invariant(_cursor->_isPinned);
+    invariant(_cursor->_isPinned.load());
 
     if (_cursor->getExecutor()->isMarkedAsKilled()) {
         // The ClientCursor was killed while we had it.  Therefore, it is our responsibility to
         // call dispose() and delete it.
         deleteUnderlying();
     } else {
-        // Unpin the cursor under the collection cursor manager lock.
+        // Hand the cursor back to the cursor manager.
         _cursor->_cursorManager->unpin(_opCtx, _cursor);
         cursorStatsOpenPinned.decrement();
     }
@@ -230,14 +230,14 @@ void ClientCursorPin::release() {
 
 void ClientCursorPin::deleteUnderlying() {
     invariant(_cursor);
-    invariant(_cursor->_isPinned);
+    invariant(_cursor->_isPinned.load());
     // Note the following subtleties of this method's implementation:
     // - We must unpin the cursor before destruction, since it is an error to delete a pinned
     //   cursor.
-    // - In addition, we must deregister the cursor before unpinning, since it is an
-    //   error to unpin a registered cursor without holding the cursor manager lock (note that
-    //   we can't simply unpin with the cursor manager lock here, since we need to guarantee
-    //   exclusive ownership of the cursor when we are deleting it).
+    // - In addition, we must deregister the cursor before unpinning, since once a registered
+    //   cursor is unpinned the cursor manager may time it out and delete it at any moment (we
+    //   can't simply unpin it here, since we need to guarantee exclusive ownership of the cursor
+    //   when we are deleting it).
 
     // Note it's not safe to dereference _cursor->_cursorManager unless we know we haven't been
     // killed. If we're not locked we assume we haven't been killed because we're working with the
@@ -252,7 +252,7 @@ void ClientCursorPin::deleteUnderlying() {
 
     // Make sure the cursor is disposed and unpinned before being destroyed.
     _cursor->dispose(_opCtx);
-    _cursor->_isPinned = false;
+    _cursor->_isPinned.store(false);
     delete _cursor;
 
     cursorStatsOpenPinned.decrement();
@@ -37,6 +37,7 @@
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/net/message.h"
 
@@ -326,7 +327,9 @@ private:
     // conditions, they can only be used while holding the CursorManager's mutex. Exceptions
     // include:
     //   - If the ClientCursor is pinned, the CursorManager will never change '_isPinned' until
-    //     asked to by the ClientCursorPin.
+    //     asked to by the ClientCursorPin. Unpinning does not take the CursorManager's mutex, so
+    //     '_lastUseDate' must be written before '_isPinned' is cleared, and may only be read by the
+    //     CursorManager after observing that '_isPinned' is false.
     //   - It is safe to read '_killed' while holding a collection lock, which must be held when
     //     interacting with a ClientCursorPin.
     //   - A ClientCursorPin can access these members after deregistering the cursor from the
@@ -340,7 +343,7 @@ private:
     // below.
     //
     // Cursors always come into existence in a pinned state.
-    bool _isPinned = true;
+    AtomicBool _isPinned{true};
 
     Date_t _lastUseDate;
 };
@@ -32,7 +32,9 @@
 
 #include "mongo/db/concurrency/lock_manager.h"
 
+#include <memory>
 #include <third_party/murmurhash3/MurmurHash3.h>
+#include <type_traits>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
@@ -156,6 +158,9 @@ struct LockHead {
 
         conversionsCount = 0;
         compatibleFirstCount = 0;
+
+        fastPathSlot = nullptr;
+        fastPathGrantedCount = 0;
     }
 
     /**
@@ -253,6 +258,23 @@ struct LockHead {
         }
     }
 
+    // Methods to maintain the requests granted through the intent lock fast path, which are
+    // counted in grantedCounts but are not on the granted queue
+    void addFastPathGrants(LockMode mode, uint32_t count) {
+        if (count == 0) {
+            return;
+        }
+        grantedCounts[mode] += count;
+        grantedModes |= modeMask(mode);
+        fastPathGrantedCount += count;
+    }
+
+    void removeFastPathGrant(LockMode mode) {
+        invariant(fastPathGrantedCount > 0);
+        fastPathGrantedCount--;
+        decGrantedModeCount(mode);
+    }
+
     // Methods to maintain the conflict queue
     void incConflictModeCount(LockMode mode) {
         invariant(conflictCounts[mode] >= 0);
@@ -328,6 +350,17 @@ struct LockHead {
     // be switched to compatible-first. As long as this value is > 0, the policy will stay
     // compatible-first.
     uint32_t compatibleFirstCount;
+
+    //
+    // Intent lock fast path
+    //
+
+    // The slot of this lock's resource while this lock keeps the fast path blocked, or nullptr.
+    IntentFastPathSlot* fastPathSlot;
+
+    // Counts the requests which were granted through the fast path before it was blocked and have
+    // not been released yet. They are included in grantedCounts, but are not on grantedList.
+    uint32_t fastPathGrantedCount;
 };
 
 /**
@@ -370,6 +403,78 @@ struct PartitionedLockHead {
     LockRequestList grantedList;
 };
 
+/**
+ * The IntentFastPathSlot lets uncontended MODE_IS and MODE_IX requests on the global, database and
+ * collection resources be granted and released with a single atomic operation, without taking any
+ * bucket or partition mutex. Each slot is claimed by the first resource that maps to it and from
+ * then on only serves that resource, so resources which collide with another one in the slot
+ * table simply keep using the partitioned lock heads.
+ *
+ * The 'state' word counts the granted MODE_IS and MODE_IX fast path requests and has a kBlocked
+ * bit. Requests for conflicting modes set kBlocked under the resource's bucket mutex and take over
+ * the counted requests as anonymous granted modes of the LockHead, so they wait for them like for
+ * any other granted request. While kBlocked is set, new intent requests use the regular path, and
+ * fast path requests which get released decrement the LockHead's counts under its bucket mutex.
+ * The bit is cleared once the LockHead has no conflicting modes and no fast path grants left.
+ *
+ * Requests granted through the fast path are not visible to the deadlock detector or lock dumps.
+ */
+struct alignas(64) IntentFastPathSlot {
+    static const uint64_t kBlocked = 1ULL << 63;
+    static const uint64_t kCountMask = 0x7FFFFFFFULL;
+
+    static uint64_t unit(LockMode mode) {
+        return mode == MODE_IS ? 1ULL : 1ULL << 32;
+    }
+
+    static uint32_t count(uint64_t state, LockMode mode) {
+        return (mode == MODE_IS ? state : state >> 32) & kCountMask;
+    }
+
+    /**
+     * Returns true if this slot belongs to the resource, claiming it if it is still unused.
+     */
+    bool claim(ResourceId resId) {
+        const uint64_t owner = resourceId.compareAndSwap(0, resId);
+        return owner == 0 || owner == resId;
+    }
+
+    /**
+     * Tries to grant the resource in an intent mode without blocking. Fails if the slot belongs to
+     * another resource or if the fast path is blocked by a conflicting request.
+     */
+    bool tryAcquire(ResourceId resId, LockMode mode) {
+        if (!claim(resId)) {
+            return false;
+        }
+
+        uint64_t current = state.load();
+        while (!(current & kBlocked)) {
+            const uint64_t previous = state.compareAndSwap(current, current + unit(mode));
+            if (previous == current) {
+                return true;
+            }
+            current = previous;
+        }
+        return false;
+    }
+
+    // Full hash of the resource owning this slot, or 0 if the slot is still unused. Never changes
+    // once set.
+    AtomicUInt64 resourceId;
+
+    // Counts of the granted fast path requests, MODE_IS in the low and MODE_IX in the high 32 bits,
+    // combined with the kBlocked bit.
+    AtomicUInt64 state;
+
+    // The LockHead which has set kBlocked, or nullptr. Protected by the owning resource's bucket
+    // mutex, which is the same for all resources mapping to this slot.
+    LockHead* blockedLock;
+};
+
+// Keeps adjacent slots on separate cache lines.
+MONGO_STATIC_ASSERT(sizeof(IntentFastPathSlot) == 64);
+
 void LockHead::migratePartitionedLockHeads() {
     invariant(partitioned());
 
@@ -414,9 +519,30 @@ const unsigned LockManager::_numLockBuckets(128);
 // The exact value doesn't appear very important, but should be power of two
 const unsigned LockManager::_numPartitions = 32;
 
+// Slots are never released by the resource which claimed them, so have plenty of them for the
+// global lock and the databases and collections in use. Must be a multiple of the number of
+// buckets, so that all resources which map to a slot also share a bucket.
+const unsigned LockManager::_numFastPathSlots = 4096;
+
 LockManager::LockManager() {
+    MONGO_STATIC_ASSERT(_numFastPathSlots % _numLockBuckets == 0);
+
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
+
+    // Array new only guarantees the alignment of std::max_align_t before C++17, so carve the
+    // cache line aligned slots out of a larger buffer.
+    size_t space = _numFastPathSlots * sizeof(IntentFastPathSlot) + alignof(IntentFastPathSlot);
+    _fastPathSlotsBuffer = new char[space];
+    void* aligned = _fastPathSlotsBuffer;
+    invariant(std::align(alignof(IntentFastPathSlot),
+                         _numFastPathSlots * sizeof(IntentFastPathSlot),
+                         aligned,
+                         space));
+    _fastPathSlots = static_cast<IntentFastPathSlot*>(aligned);
+    for (unsigned i = 0; i < _numFastPathSlots; i++) {
+        new (&_fastPathSlots[i]) IntentFastPathSlot();
+    }
 }
 
 LockManager::~LockManager() {
@@ -429,6 +555,9 @@ LockManager::~LockManager() {
 
     delete[] _lockBuckets;
     delete[] _partitions;
+    // The slots are trivially destructible, so only their buffer needs to be freed.
+    MONGO_STATIC_ASSERT(std::is_trivially_destructible<IntentFastPathSlot>::value);
+    delete[] _fastPathSlotsBuffer;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -439,6 +568,17 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
 
+    // Lock-free fast path for uncontended intent locks. Requests which change the queueing policy
+    // must be on the LockHead.
+    if (request->partitioned && !request->enqueueAtFront && !request->compatibleFirst) {
+        IntentFastPathSlot* slot = _getFastPathSlot(resId);
+        if (slot && slot->tryAcquire(resId, mode)) {
+            request->fastPathSlot = slot;
+            request->status = LockRequest::STATUS_GRANTED;
+            return LOCK_OK;
+        }
+    }
+
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
         Partition* partition = _getPartition(request);
@@ -478,6 +618,10 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
         lock->migratePartitionedLockHeads();
     }
 
+    if (!request->partitioned) {
+        _blockFastPath(lock);
+    }
+
     request->partitioned = false;
     return lock->newRequest(request);
 }
@@ -508,15 +652,25 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
     LockBucket* bucket = _getBucket(resId);
     stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
 
-    LockBucket::Map::iterator it = bucket->data.find(resId);
-    invariant(it != bucket->data.end());
-
-    LockHead* const lock = it->second;
+    LockHead* lock;
+    if (request->fastPathSlot) {
+        // Requests granted through the fast path are not on the LockHead, which may not even exist
+        lock = bucket->findOrInsert(resId);
+        _adoptFastPathRequest(lock, request);
+    } else {
+        LockBucket::Map::iterator it = bucket->data.find(resId);
+        invariant(it != bucket->data.end());
+        lock = it->second;
+    }
 
     if (lock->partitioned()) {
         lock->migratePartitionedLockHeads();
     }
 
+    if (!(modeMask(newMode) & intentModes)) {
+        _blockFastPath(lock);
+    }
+
     // Construct granted mask without our current mode, so that it is not counted as
     // conflicting
     uint32_t grantedModesWithoutCurrentRequest = 0;
@@ -552,6 +706,10 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
         lock->decGrantedModeCount(request->mode);
         request->mode = newMode;
 
+        // Adopting a fast path request for an intent mode conversion may have blocked the fast
+        // path without any conflicting mode
+        _unblockFastPathIfPossible(lock);
+
         return LOCK_OK;
     }
 }
@@ -567,6 +725,28 @@ bool LockManager::unlock(LockRequest* request) {
         return false;
     }
 
+    if (request->fastPathSlot) {
+        IntentFastPathSlot* slot = request->fastPathSlot;
+        request->fastPathSlot = nullptr;
+
+        //  Fast path: no conflicting request has seen this one.
+        const uint64_t state =
+            slot->state.fetchAndSubtract(IntentFastPathSlot::unit(request->mode));
+        if (!(state & IntentFastPathSlot::kBlocked)) {
+            return true;
+        }
+
+        // A conflicting request has accounted for this one on the LockHead, so release it there.
+        LockBucket* bucket = _getFastPathBucket(slot);
+        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+        LockHead* lock = slot->blockedLock;
+        invariant(lock);
+        lock->removeFastPathGrant(request->mode);
+        _onLockModeChanged(lock, lock->grantedCounts[request->mode] == 0);
+        return true;
+    }
+
     if (request->partitioned) {
         // Unlocking a lock that was acquired as partitioned. The lock request may since have
         // moved to the lock head, but there is no safe way to find out without synchronizing
@@ -635,6 +815,23 @@ bool LockManager::unlock(LockRequest* request) {
 }
 
 void LockManager::downgrade(LockRequest* request, LockMode newMode) {
+    if (request->fastPathSlot) {
+        IntentFastPathSlot* slot = request->fastPathSlot;
+        LockBucket* bucket = _getFastPathBucket(slot);
+        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+        // The fast path can only be blocked or unblocked under this bucket's mutex
+        if (!slot->blockedLock) {
+            invariant(newMode == MODE_IS);
+            slot->state.fetchAndAdd(IntentFastPathSlot::unit(newMode) -
+                                    IntentFastPathSlot::unit(request->mode));
+            request->mode = newMode;
+            return;
+        }
+
+        _adoptFastPathRequest(slot->blockedLock, request);
+    }
+
     invariant(request->lock);
     invariant(request->status == LockRequest::STATUS_GRANTED);
     invariant(request->recursiveCount > 0);
@@ -683,6 +880,7 @@ void LockManager::_cleanupUnusedLocksInBucket(LockBucket* bucket) {
             invariant(lock->conflictList._back == nullptr);
             invariant(lock->conversionsCount == 0);
             invariant(lock->compatibleFirstCount == 0);
+            invariant(lock->fastPathSlot == nullptr);
 
             bucket->data.erase(it++);
             deletedLockHeads++;
@@ -797,9 +995,12 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         }
     }
 
+    _unblockFastPathIfPossible(lock);
+
     // This is a convenient place to check that the state of the two request queues is in sync
     // with the bitmask on the modes.
-    invariant((lock->grantedModes == 0) ^ (lock->grantedList._front != nullptr));
+    invariant((lock->grantedModes == 0) ^
+              (lock->grantedList._front != nullptr || lock->fastPathGrantedCount > 0));
     invariant((lock->conflictModes == 0) ^ (lock->conflictList._front != nullptr));
 }
 
@@ -811,6 +1012,78 @@ LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
+LockManager::LockBucket* LockManager::_getFastPathBucket(IntentFastPathSlot* slot) const {
+    return &_lockBuckets[(slot - _fastPathSlots) % _numLockBuckets];
+}
+
+IntentFastPathSlot* LockManager::_getFastPathSlot(ResourceId resId) const {
+    switch (resId.getType()) {
+        case RESOURCE_GLOBAL:
+        case RESOURCE_DATABASE:
+        case RESOURCE_COLLECTION:
+            return &_fastPathSlots[resId % _numFastPathSlots];
+        default:
+            return nullptr;
+    }
+}
+
+void LockManager::_blockFastPath(LockHead* lock) {
+    if (lock->fastPathSlot) {
+        return;  // Already blocked
+    }
+
+    // Claim unused slots as well, so that no intent request can slip through the fast path.
+    IntentFastPathSlot* slot = _getFastPathSlot(lock->resourceId);
+    if (!slot || !slot->claim(lock->resourceId)) {
+        return;
+    }
+
+    // No fast path request can be granted after this, and every one counted here will release
+    // itself through the LockHead, which can only happen after this bucket mutex is released.
+    const uint64_t state = slot->state.fetchAndAdd(IntentFastPathSlot::kBlocked);
+    invariant(!(state & IntentFastPathSlot::kBlocked));
+
+    lock->fastPathSlot = slot;
+    slot->blockedLock = lock;
+    lock->addFastPathGrants(MODE_IS, IntentFastPathSlot::count(state, MODE_IS));
+    lock->addFastPathGrants(MODE_IX, IntentFastPathSlot::count(state, MODE_IX));
+}
+
+void LockManager::_adoptFastPathRequest(LockHead* lock, LockRequest* request) {
+    invariant(request->fastPathSlot);
+    invariant(request->status == LockRequest::STATUS_GRANTED);
+
+    _blockFastPath(lock);
+    invariant(lock->fastPathSlot == request->fastPathSlot);
+
+    // The request is now accounted for on the LockHead, which must not wait for it to be released
+    // through the fast path.
+    const uint64_t state =
+        request->fastPathSlot->state.fetchAndSubtract(IntentFastPathSlot::unit(request->mode));
+    invariant(state & IntentFastPathSlot::kBlocked);
+    lock->removeFastPathGrant(request->mode);
+    request->fastPathSlot = nullptr;
+    request->partitioned = false;
+
+    // The request is already granted, so it goes straight to the granted queue regardless of any
+    // pending conflicting requests.
+    request->lock = lock;
+    lock->grantedList.push_back(request);
+    lock->incGrantedModeCount(request->mode);
+}
+
+void LockManager::_unblockFastPathIfPossible(LockHead* lock) {
+    if (!lock->fastPathSlot || lock->fastPathGrantedCount || lock->conflictModes ||
+        (lock->grantedModes & ~intentModes)) {
+        return;
+    }
+
+    const uint64_t state = lock->fastPathSlot->state.fetchAndSubtract(IntentFastPathSlot::kBlocked);
+    invariant(state == IntentFastPathSlot::kBlocked);
+    lock->fastPathSlot->blockedLock = nullptr;
+    lock->fastPathSlot = nullptr;
+}
+
 void LockManager::dump() const {
     log() << "Dumping LockManager @ " << static_cast<const void*>(this) << '\n';
 
@@ -1168,6 +1441,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
 
     lock = nullptr;
     partitionedLock = nullptr;
+    fastPathSlot = nullptr;
     prev = nullptr;
     next = nullptr;
     status = STATUS_NEW;
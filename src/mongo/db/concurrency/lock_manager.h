@@ -170,6 +170,37 @@ private:
      */
     Partition* _getPartition(LockRequest* request) const;
 
+    /**
+     * Retrieves the slot used by the lock-free intent lock fast path for the particular resource,
+     * or nullptr if resources of its type never use the fast path. The slot may belong to another
+     * resource, in which case it must not be used for this one.
+     */
+    IntentFastPathSlot* _getFastPathSlot(ResourceId resId) const;
+
+    /**
+     * Retrieves the bucket of the resource which owns the particular fast path slot.
+     */
+    LockBucket* _getFastPathBucket(IntentFastPathSlot* slot) const;
+
+    /**
+     * Stops granting intent locks on the lock's resource through the fast path, and accounts for
+     * the requests which were already granted that way as granted modes on the lock. Must be
+     * called under the lock bucket's mutex before granting or queueing a conflicting mode.
+     */
+    void _blockFastPath(LockHead* lock);
+
+    /**
+     * Moves a request granted through the fast path onto the lock's granted queue, so that it can
+     * be converted or downgraded. MUST be called under the lock bucket's mutex.
+     */
+    void _adoptFastPathRequest(LockHead* lock, LockRequest* request);
+
+    /**
+     * Re-enables the fast path for the lock's resource once no conflicting modes are granted or
+     * waiting. MUST be called under the lock bucket's mutex.
+     */
+    void _unblockFastPathIfPossible(LockHead* lock);
+
     /**
      * Prints the contents of a bucket to the log.
      */
@@ -216,6 +247,10 @@ private:
 
     static const unsigned _numPartitions;
     Partition* _partitions;
+
+    static const unsigned _numFastPathSlots;
+    IntentFastPathSlot* _fastPathSlots;  // Cache line aligned, points into _fastPathSlotsBuffer.
+    char* _fastPathSlotsBuffer;
 };
 
 
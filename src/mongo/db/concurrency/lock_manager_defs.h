@@ -41,6 +41,7 @@ namespace mongo {
 
 class Locker;
 
+struct IntentFastPathSlot;
 struct LockHead;
 struct PartitionedLockHead;
 
@@ -407,6 +408,16 @@ struct LockRequest {
     // Protected by LockHead bucket's mutex
     PartitionedLockHead* partitionedLock;
 
+    // Pointer to the fast path slot which counts this request, or null if it was not granted
+    // through the lock-free intent lock fast path. When set, both 'lock' and 'partitionedLock' are
+    // null. A request can only transition from 'fastPathSlot' to 'lock', never the other way
+    // around.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    IntentFastPathSlot* fastPathSlot;
+
     // The linked list chain on which this request hangs off the owning lock head. The reason
     // intrusive linked list is used instead of the std::list class is to allow for entries to be
     // removed from the middle of the list in O(1) time, if they are known instead of having to
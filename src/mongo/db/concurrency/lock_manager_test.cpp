@@ -951,4 +951,99 @@ TEST(LockManager, Fairness) {
     ASSERT(lockMgr.unlock(&requestIX1));
 }
 
+TEST(LockManager, IntentFastPathConvertWaitsForOtherHolders) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_DATABASE, std::string("TestDB"));
+
+    MMAPV1LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IX));
+
+    MMAPV1LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request2, MODE_IX));
+
+    // The upgrade must wait for the other intent lock, even though nothing was ever queued
+    ASSERT(LOCK_WAITING == lockMgr.convert(resId, &request1, MODE_X));
+    ASSERT_EQ(0, request1.numNotifies);
+
+    // New intent requests are queued behind the conversion
+    MMAPV1LockerImpl locker3;
+    LockRequestCombo request3(&locker3);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &request3, MODE_IS));
+
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT_EQ(1, request1.numNotifies);
+    ASSERT_EQ(LOCK_OK, request1.lastResult);
+    ASSERT(request1.mode == MODE_X);
+    ASSERT_EQ(0, request3.numNotifies);
+
+    // Releasing the upgrade and then the original acquisition grants the queued request
+    ASSERT(!lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+    ASSERT_EQ(1, request3.numNotifies);
+    ASSERT_EQ(LOCK_OK, request3.lastResult);
+    ASSERT(lockMgr.unlock(&request3));
+
+    // Once all conflicting requests are gone, intent locks are granted right away again
+    LockRequestCombo request4(&locker1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request4, MODE_IX));
+    ASSERT(lockMgr.unlock(&request4));
+}
+
+TEST(LockManager, IntentFastPathDowngrade) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    MMAPV1LockerImpl lockerIX;
+    LockRequestCombo requestIX(&lockerIX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+
+    MMAPV1LockerImpl lockerS;
+    LockRequestCombo requestS(&lockerS);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestS, MODE_S));
+
+    // MODE_IS does not conflict with MODE_S, so the downgrade unblocks the waiting request
+    lockMgr.downgrade(&requestIX, MODE_IS);
+    ASSERT(requestIX.mode == MODE_IS);
+    ASSERT_EQ(1, requestS.numNotifies);
+    ASSERT_EQ(LOCK_OK, requestS.lastResult);
+
+    ASSERT(lockMgr.unlock(&requestS));
+    ASSERT(lockMgr.unlock(&requestIX));
+}
+
+TEST(LockManager, IntentFastPathManyResources) {
+    LockManager lockMgr;
+
+    // More resources than fast path slots, so some of them must share slots and fall back to the
+    // partitioned lock heads
+    const int numResources = 10000;
+    std::vector<ResourceId> resIds;
+    for (int i = 0; i < numResources; i++) {
+        resIds.push_back(ResourceId(RESOURCE_COLLECTION, "TestDB.collection" + std::to_string(i)));
+    }
+
+    MMAPV1LockerImpl lockerIX;
+    std::vector<std::unique_ptr<LockRequestCombo>> requestsIX;
+    for (const auto& resId : resIds) {
+        requestsIX.emplace_back(new LockRequestCombo(&lockerIX));
+        ASSERT(LOCK_OK == lockMgr.lock(resId, requestsIX.back().get(), MODE_IX));
+    }
+
+    MMAPV1LockerImpl lockerX;
+    std::vector<std::unique_ptr<LockRequestCombo>> requestsX;
+    for (const auto& resId : resIds) {
+        requestsX.emplace_back(new LockRequestCombo(&lockerX));
+        ASSERT(LOCK_WAITING == lockMgr.lock(resId, requestsX.back().get(), MODE_X));
+    }
+
+    for (int i = 0; i < numResources; i++) {
+        ASSERT(lockMgr.unlock(requestsIX[i].get()));
+        ASSERT_EQ(1, requestsX[i]->numNotifies);
+        ASSERT_EQ(LOCK_OK, requestsX[i]->lastResult);
+        ASSERT(lockMgr.unlock(requestsX[i].get()));
+    }
+}
+
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/new.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/current_cpu.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
@@ -48,7 +49,9 @@ namespace mongo {
 namespace {
 
 /**
- * Partitioned global lock statistics, so we don't hit the same bucket.
+ * Partitioned global lock statistics, so that lockers running on different CPUs don't bounce the
+ * same cache lines on every acquisition. The partitions are only aggregated when the statistics
+ * are reported.
  */
 class PartitionedInstanceWideLockStats {
     MONGO_DISALLOW_COPYING(PartitionedInstanceWideLockStats);
@@ -56,20 +59,20 @@ class PartitionedInstanceWideLockStats {
 public:
     PartitionedInstanceWideLockStats() {}
 
-    void recordAcquisition(LockerId id, ResourceId resId, LockMode mode) {
-        _get(id).recordAcquisition(resId, mode);
+    void recordAcquisition(ResourceId resId, LockMode mode) {
+        _get().recordAcquisition(resId, mode);
     }
 
-    void recordWait(LockerId id, ResourceId resId, LockMode mode) {
-        _get(id).recordWait(resId, mode);
+    void recordWait(ResourceId resId, LockMode mode) {
+        _get().recordWait(resId, mode);
     }
 
-    void recordWaitTime(LockerId id, ResourceId resId, LockMode mode, uint64_t waitMicros) {
-        _get(id).recordWaitTime(resId, mode, waitMicros);
+    void recordWaitTime(ResourceId resId, LockMode mode, uint64_t waitMicros) {
+        _get().recordWaitTime(resId, mode, waitMicros);
     }
 
     void recordDeadlock(ResourceId resId, LockMode mode) {
-        _get(resId).recordDeadlock(resId, mode);
+        _get().recordDeadlock(resId, mode);
     }
 
     void report(SingleThreadedLockStats* outStats) const {
@@ -91,11 +94,13 @@ private:
         AtomicLockStats stats;
     };
 
-    enum { NumPartitions = 8 };
+    // Machines with more CPUs than this share partitions between CPUs.
+    enum { NumPartitions = 64 };
 
 
-    AtomicLockStats& _get(LockerId id) {
-        return _partitions[id % NumPartitions].stats;
+    AtomicLockStats& _get() {
+        // The counters stay atomic, because a thread may migrate to another CPU at any time.
+        return _partitions[currentCPUOrThreadIndex() % NumPartitions].stats;
     }
 
 
@@ -122,7 +127,7 @@ const Milliseconds DeadlockTimeout = Milliseconds(500);
 // Dispenses unique LockerId identifiers
 AtomicUInt64 idCounter(0);
 
-// Partitioned global lock statistics, so we don't hit the same bucket
+// Partitioned global lock statistics, so we don't hit the same cache lines from every CPU
 PartitionedInstanceWideLockStats globalStats;
 
 
@@ -365,7 +370,7 @@ void LockerImpl<IsForMMAPV1>::downgradeGlobalXtoSForMMAPV1() {
     // so it's OK.
 
     // Making this call here will record lock downgrades as acquisitions, which is acceptable
-    globalStats.recordAcquisition(_id, resourceIdGlobal, MODE_S);
+    globalStats.recordAcquisition(resourceIdGlobal, MODE_S);
     _stats.recordAcquisition(resourceIdGlobal, MODE_S);
 
     globalLockManager.downgrade(globalLockRequest, MODE_S);
@@ -678,7 +683,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(ResourceId resId, LockMode mode) {
     }
 
     // Making this call here will record lock re-acquisitions and conversions as well.
-    globalStats.recordAcquisition(_id, resId, mode);
+    globalStats.recordAcquisition(resId, mode);
     _stats.recordAcquisition(resId, mode);
 
     // Give priority to the full modes for global, parallel batch writer mode,
@@ -711,7 +716,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(ResourceId resId, LockMode mode) {
                               : globalLockManager.convert(resId, request, mode);
 
     if (result == LOCK_WAITING) {
-        globalStats.recordWait(_id, resId, mode);
+        globalStats.recordWait(resId, mode);
         _stats.recordWait(resId, mode);
     }
 
@@ -751,7 +756,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
         const uint64_t elapsedTimeMicros = curTimeMicros - startOfCurrentWaitTime;
         startOfCurrentWaitTime = curTimeMicros;
 
-        globalStats.recordWaitTime(_id, resId, mode, elapsedTimeMicros);
+        globalStats.recordWaitTime(resId, mode, elapsedTimeMicros);
         _stats.recordWaitTime(resId, mode, elapsedTimeMicros);
 
         if (result == LOCK_OK)
@@ -30,6 +30,7 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -100,4 +101,33 @@ TEST(LockStats, Reporting) {
     stats.report(&builder);
 }
 
+TEST(LockStats, MultipleThreads) {
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("LockStats.MultipleThreads"));
+
+    resetGlobalLockStats();
+
+    // Acquisitions from different threads may land in different partitions, but none may be lost
+    const int numThreads = 8;
+    const int numAcquisitionsPerThread = 1000;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back([&] {
+            LockerForTests locker(MODE_IX);
+            for (int j = 0; j < numAcquisitionsPerThread; j++) {
+                locker.lock(resId, MODE_IX);
+                locker.unlock(resId);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    SingleThreadedLockStats stats;
+    reportGlobalLockingStats(&stats);
+
+    ASSERT_EQUALS(numThreads * numAcquisitionsPerThread, stats.get(resId, MODE_IX).numAcquisitions);
+    ASSERT_EQUALS(0, stats.get(resId, MODE_IX).numWaits);
+}
+
 }  // namespace mongo
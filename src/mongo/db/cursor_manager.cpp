@@ -388,7 +388,7 @@ void CursorManager::invalidateAll(OperationContext* opCtx,
 
             // If pinned, there is an active user of this cursor, who is now responsible for
             // cleaning it up. Otherwise, we can immediately dispose of it.
-            if (cursor->_isPinned) {
+            if (cursor->_isPinned.load()) {
                 it = partition.erase(it);
                 continue;
             }
@@ -434,7 +434,7 @@ void CursorManager::invalidateDocument(OperationContext* opCtx,
 }
 
 bool CursorManager::cursorShouldTimeout_inlock(const ClientCursor* cursor, Date_t now) {
-    if (cursor->isNoTimeout() || cursor->_isPinned) {
+    if (cursor->isNoTimeout() || cursor->_isPinned.load()) {
         return false;
     }
     return (now - cursor->_lastUseDate) >= Milliseconds(cursorTimeoutMillis.load());
@@ -487,7 +487,9 @@ StatusWith<ClientCursorPin> CursorManager::pinCursor(OperationContext* opCtx, Cu
     }
 
     ClientCursor* cursor = it->second;
-    uassert(12051, str::stream() << "cursor id " << id << " is already in use", !cursor->_isPinned);
+    uassert(12051,
+            str::stream() << "cursor id " << id << " is already in use",
+            !cursor->_isPinned.load());
     if (cursor->getExecutor()->isMarkedAsKilled()) {
         // This cursor was killed while it was idle.
         Status error{ErrorCodes::QueryPlanKilled,
@@ -498,7 +500,7 @@ StatusWith<ClientCursorPin> CursorManager::pinCursor(OperationContext* opCtx, Cu
         delete cursor;
         return error;
     }
-    cursor->_isPinned = true;
+    cursor->_isPinned.store(true);
     return ClientCursorPin(opCtx, cursor);
 }
 
@@ -506,10 +508,11 @@ void CursorManager::unpin(OperationContext* opCtx, ClientCursor* cursor) {
     // Avoid computing the current time within the critical section.
     auto now = opCtx->getServiceContext()->getPreciseClockSource()->now();
 
-    auto partitionLock = _cursorMap->lockOnePartition(cursor->cursorid());
-    invariant(cursor->_isPinned);
-    cursor->_isPinned = false;
+    // No lock is needed, since nothing else may modify a pinned cursor. '_lastUseDate' is written
+    // first, so that anyone who sees the cursor unpinned also sees when it was last used.
+    invariant(cursor->_isPinned.load());
     cursor->_lastUseDate = now;
+    cursor->_isPinned.store(false);
 }
 
 void CursorManager::getCursorIds(std::set<CursorId>* openCursors) const {
@@ -553,28 +556,26 @@ size_t CursorManager::numCursors() const {
     return _cursorMap->size();
 }
 
-CursorId CursorManager::allocateCursorId_inlock() {
-    for (int i = 0; i < 10000; i++) {
-        // The leading two bits of a CursorId are used to determine if the cursor is registered on
-        // the global cursor manager.
-        CursorId id;
-        if (isGlobalManager()) {
-            // This is the global cursor manager, so generate a random number and make sure the
-            // first two bits are 01.
-            uint64_t mask = 0x3FFFFFFFFFFFFFFF;
-            uint64_t bitToSet = 1ULL << 62;
-            id = ((_random->nextInt64() & mask) | bitToSet);
-        } else {
-            // The first 2 bits are 0, the next 30 bits are the collection identifier, the next 32
-            // bits are random.
-            uint32_t myPart = static_cast<uint32_t>(_random->nextInt32());
-            id = cursorIdFromParts(_collectionCacheRuntimeId, myPart);
-        }
-        auto partition = _cursorMap->lockOnePartition(id);
-        if (partition->count(id) == 0)
-            return id;
+CursorId CursorManager::generateCursorId() {
+    // The leading two bits of a CursorId are used to determine if the cursor is registered on the
+    // global cursor manager.
+    if (isGlobalManager()) {
+        // This is the global cursor manager, so generate a random number and make sure the first
+        // two bits are 01.
+        uint64_t mask = 0x3FFFFFFFFFFFFFFF;
+        uint64_t bitToSet = 1ULL << 62;
+        stdx::lock_guard<SimpleMutex> lock(_randomLock);
+        return ((_random->nextInt64() & mask) | bitToSet);
     }
-    fassertFailed(17360);
+
+    // The first 2 bits are 0, the next 30 bits are the collection identifier, the next 32 bits are
+    // random.
+    uint32_t myPart;
+    {
+        stdx::lock_guard<SimpleMutex> lock(_randomLock);
+        myPart = static_cast<uint32_t>(_random->nextInt32());
+    }
+    return cursorIdFromParts(_collectionCacheRuntimeId, myPart);
 }
 
 ClientCursorPin CursorManager::registerCursor(OperationContext* opCtx,
@@ -589,18 +590,22 @@ ClientCursorPin CursorManager::registerCursor(OperationContext* opCtx,
     cursorParams.exec.get_deleter().dismissDisposal();
     cursorParams.exec->unsetRegistered();
 
-    // Note we must hold the registration lock from now until insertion into '_cursorMap' to ensure
-    // we don't insert two cursors with the same cursor id.
-    stdx::lock_guard<SimpleMutex> lock(_registrationLock);
-    CursorId cursorId = allocateCursorId_inlock();
-    std::unique_ptr<ClientCursor, ClientCursor::Deleter> clientCursor(new ClientCursor(
-        std::move(cursorParams), this, cursorId, opCtx->getLogicalSessionId(), now));
+    for (int i = 0; i < 10000; i++) {
+        // We must check that the id is unused and insert the new cursor under the same partition
+        // lock, to ensure we don't insert two cursors with the same cursor id.
+        CursorId cursorId = generateCursorId();
+        auto partition = _cursorMap->lockOnePartition(cursorId);
+        if (partition->count(cursorId) != 0) {
+            continue;
+        }
 
-    // Transfer ownership of the cursor to '_cursorMap'.
-    auto partition = _cursorMap->lockOnePartition(cursorId);
-    ClientCursor* unownedCursor = clientCursor.release();
-    partition->emplace(cursorId, unownedCursor);
-    return ClientCursorPin(opCtx, unownedCursor);
+        // Transfer ownership of the cursor to '_cursorMap'.
+        ClientCursor* unownedCursor = new ClientCursor(
+            std::move(cursorParams), this, cursorId, opCtx->getLogicalSessionId(), now);
+        partition->emplace(cursorId, unownedCursor);
+        return ClientCursorPin(opCtx, unownedCursor);
+    }
+    fassertFailed(17360);
 }
 
 void CursorManager::deregisterCursor(ClientCursor* cc) {
@@ -619,7 +624,7 @@ Status CursorManager::eraseCursor(OperationContext* opCtx, CursorId id, bool sho
     }
     auto cursor = it->second;
 
-    if (cursor->_isPinned) {
+    if (cursor->_isPinned.load()) {
         if (shouldAudit) {
             audit::logKillCursorsAuthzCheck(
                 opCtx->getClient(), _nss, id, ErrorCodes::OperationFailed);
@@ -213,7 +213,11 @@ private:
     struct PlanExecutorPartitioner {
         std::size_t operator()(const PlanExecutor* exec, std::size_t nPartitions);
     };
-    CursorId allocateCursorId_inlock();
+    /**
+     * Returns a candidate id for a new cursor. The id is only reserved once a cursor has been
+     * inserted into '_cursorMap' under it.
+     */
+    CursorId generateCursorId();
 
     ClientCursorPin _registerCursor(
         OperationContext* opCtx, std::unique_ptr<ClientCursor, ClientCursor::Deleter> clientCursor);
@@ -241,17 +245,19 @@ private:
     // There are several mutexes at work to protect concurrent access to data structures managed by
     // this cursor manager. The two registration data structures '_registeredPlanExecutors' and
     // '_cursorMap' are partitioned to decrease contention, and each partition of the structure is
-    // protected by its own mutex. Separately, there is a '_registrationLock' which protects
-    // concurrent access to '_random' for cursor id generation, and must be held from cursor id
-    // generation until insertion into '_cursorMap'. If you ever need to acquire more than one of
-    // these mutexes at once, you must follow the following rules:
-    // - '_registrationLock' must be acquired first, if at all.
-    // - Mutex(es) for '_registeredPlanExecutors' must be acquired next.
+    // protected by its own mutex. A cursor id is reserved by checking for and inserting the new
+    // cursor under the lock of the '_cursorMap' partition the id belongs to, so cursors in
+    // different partitions are registered concurrently. Separately, '_randomLock' protects
+    // '_random', and is only held while generating a candidate cursor id. Unpinning a cursor takes
+    // none of these mutexes; see ClientCursor::_isPinned. If you ever need to acquire more than
+    // one of these mutexes at once, you must follow the following rules:
+    // - '_randomLock' must not be held while acquiring any other mutex.
+    // - Mutex(es) for '_registeredPlanExecutors' must be acquired first.
     // - Mutex(es) for '_cursorMap' must be acquired next.
     // - If you need to access multiple partitions within '_registeredPlanExecutors' or '_cursorMap'
     //   at once, you must acquire the mutexes for those partitions in ascending order, or use the
     //   partition helpers to acquire mutexes for all partitions.
-    mutable SimpleMutex _registrationLock;
+    SimpleMutex _randomLock;
     std::unique_ptr<PseudoRandom> _random;
     Partitioned<unordered_set<PlanExecutor*>, kNumPartitions, PlanExecutorPartitioner>
         _registeredPlanExecutors;
@@ -35,9 +35,11 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/parallel_filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -51,6 +53,15 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+
+// When the filter is applied in parallel, a batch is filtered once it has this many records or
+// this many bytes of documents, whichever comes first.
+const size_t kMaxRecordsPerFilterBatch = 1024;
+const size_t kMaxBytesPerFilterBatch = 16 * 1024 * 1024;
+
+}  // namespace
+
 // static
 const char* CollectionScan::kStageType = "COLLSCAN";
 
@@ -66,6 +77,68 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
       _wsidForFetch(_workingSet->allocate()) {
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
+
+    if (canFilterInParallel()) {
+        _parallelFilter = make_unique<ParallelFilter>(internalQueryCollScanFilterThreads.load());
+    }
+
+    if (_filter && internalQueryCompileFilters.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
+}
+
+CollectionScan::~CollectionScan() = default;
+
+bool CollectionScan::canFilterInParallel() const {
+    if (!_params.allowParallelFilter || internalQueryCollScanFilterThreads.load() <= 0) {
+        return false;
+    }
+
+    // Tailable and oplog scans return records as soon as they are read or stop filtering partway
+    // through, so they get no benefit from reading ahead.
+    if (_params.tailable || _params.stopApplyingFilterAfterFirstMatch) {
+        return false;
+    }
+
+    return ParallelFilter::canApply(getOpCtx(), _filter);
+}
+
+void CollectionScan::filterBufferedRecords() {
+    const size_t numRecords = _unfilteredRecords.size();
+    if (0 == numRecords) {
+        return;
+    }
+
+    // Don't use std::vector<bool>, whose elements can't be written from different threads.
+    std::vector<char> matches(numRecords, false);
+    _parallelFilter->run(
+        [this](size_t i) {
+            const BSONObj& obj = _unfilteredRecords[i].obj;
+            return _compiledFilter ? _compiledFilter->matchesBSON(obj) : _filter->matchesBSON(obj);
+        },
+        &matches);
+
+    for (size_t i = 0; i < numRecords; ++i) {
+        if (matches[i]) {
+            _matchedRecords.push_back(std::move(_unfilteredRecords[i]));
+        }
+    }
+    _unfilteredRecords.clear();
+    _unfilteredBytes = 0;
+}
+
+PlanStage::StageState CollectionScan::returnNextMatched(WorkingSetID* out) {
+    BufferedRecord& record = _matchedRecords.front();
+
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = record.id;
+    member->obj = {record.snapshotId, record.obj};
+    _workingSet->transitionToRecordIdAndObj(id);
+    _matchedRecords.pop_front();
+
+    *out = id;
+    return PlanStage::ADVANCED;
 }
 
 PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
@@ -80,11 +153,19 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::DEAD;
     }
 
+    if (!_matchedRecords.empty()) {
+        return returnNextMatched(out);
+    }
+
     if ((0 != _params.maxScan) && (_specificStats.docsTested >= _params.maxScan)) {
         _commonStats.isEOF = true;
     }
 
     if (_commonStats.isEOF) {
+        if (!_unfilteredRecords.empty()) {
+            filterBufferedRecords();
+            return PlanStage::NEED_TIME;
+        }
         return PlanStage::IS_EOF;
     }
 
@@ -156,27 +237,106 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     }
 
     if (!record) {
-        // We just hit EOF. If we are tailable and have already returned data, leave us in a
-        // state to pick up where we left off on the next call to work(). Otherwise EOF is
-        // permanent.
-        if (_params.tailable && !_lastSeenId.isNull()) {
-            _cursor.reset();
-        } else {
-            _commonStats.isEOF = true;
-        }
+        handleEndOfCursor();
 
+        if (!_unfilteredRecords.empty()) {
+            filterBufferedRecords();
+            return PlanStage::NEED_TIME;
+        }
         return PlanStage::IS_EOF;
     }
 
     _lastSeenId = record->id;
 
+    if (_parallelFilter) {
+        ++_specificStats.docsTested;
+        BSONObj obj = record->data.releaseToBson().getOwned();
+        _unfilteredBytes += obj.objsize();
+        _unfilteredRecords.push_back(
+            {record->id, getOpCtx()->recoveryUnit()->getSnapshotId(), std::move(obj)});
+        if (_unfilteredRecords.size() >= kMaxRecordsPerFilterBatch ||
+            _unfilteredBytes >= kMaxBytesPerFilterBatch) {
+            filterBufferedRecords();
+        }
+        return PlanStage::NEED_TIME;
+    }
+
+    WorkingSetID id = allocateMember(record.get_ptr());
+    return returnIfMatches(_workingSet->get(id), id, out);
+}
+
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxWork,
+                                                  WorkingSet* ws,
+                                                  std::vector<WorkingSetID>* batch,
+                                                  WorkingSetID* out) {
+    // Creating or re-creating the cursor, seeking to the start of the scan, applying the filter in
+    // parallel and reporting a dead scan are left to doWork(). Otherwise the records are read
+    // one after another until the batch is full.
+    const bool needToSeek = _lastSeenId.isNull() && !_params.start.isNull();
+    if (!_cursor || needToSeek || _parallelFilter || _isDead || _commonStats.isEOF) {
+        return PlanStage::doWorkBatch(maxWork, ws, batch, out);
+    }
+
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < maxWork && batchBytes <= kMaxWorkBatchBytes; ++i) {
+        if ((0 != _params.maxScan) && (_specificStats.docsTested >= _params.maxScan)) {
+            _commonStats.isEOF = true;
+            return PlanStage::IS_EOF;
+        }
+
+        boost::optional<Record> record;
+        try {
+            if (auto fetcher = _cursor->fetcherForNext()) {
+                WorkingSetMember* member = _workingSet->get(_wsidForFetch);
+                member->setFetcher(fetcher.release());
+                *out = _wsidForFetch;
+                return PlanStage::NEED_YIELD;
+            }
+
+            record = _cursor->next();
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        if (!record) {
+            handleEndOfCursor();
+            return PlanStage::IS_EOF;
+        }
+
+        _lastSeenId = record->id;
+
+        WorkingSetID id = allocateMember(record.get_ptr());
+        WorkingSetID matchedId;
+        if (PlanStage::ADVANCED == returnIfMatches(_workingSet->get(id), id, &matchedId)) {
+            // The next record read from the cursor may reuse the memory this one points into.
+            WorkingSetMember* member = _workingSet->get(matchedId);
+            member->makeObjOwnedIfNeeded();
+            batchBytes += member->getMemUsage();
+            batch->push_back(matchedId);
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
+void CollectionScan::handleEndOfCursor() {
+    // If we are tailable and have already returned data, leave us in a state to pick up where we
+    // left off on the next call to work(). Otherwise EOF is permanent.
+    if (_params.tailable && !_lastSeenId.isNull()) {
+        _cursor.reset();
+    } else {
+        _commonStats.isEOF = true;
+    }
+}
+
+WorkingSetID CollectionScan::allocateMember(Record* record) {
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
     member->recordId = record->id;
     member->obj = {getOpCtx()->recoveryUnit()->getSnapshotId(), record->data.releaseToBson()};
     _workingSet->transitionToRecordIdAndObj(id);
-
-    return returnIfMatches(member, id, out);
+    return id;
 }
 
 PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
@@ -184,9 +344,10 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
+            _compiledFilter.reset();
         }
         *out = memberID;
         return PlanStage::ADVANCED;
@@ -197,7 +358,8 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
 }
 
 bool CollectionScan::isEOF() {
-    return _commonStats.isEOF || _isDead;
+    return (_commonStats.isEOF && _matchedRecords.empty() && _unfilteredRecords.empty()) ||
+        _isDead;
 }
 
 void CollectionScan::doInvalidate(OperationContext* opCtx,
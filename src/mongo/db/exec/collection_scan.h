@@ -28,16 +28,23 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/snapshot.h"
 
 namespace mongo {
 
+class ParallelFilter;
+
 class SeekableRecordCursor;
+struct Record;
 class WorkingSet;
 class OperationContext;
 
@@ -54,7 +61,13 @@ public:
                    WorkingSet* workingSet,
                    const MatchExpression* filter);
 
+    ~CollectionScan();
+
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWork,
+                           WorkingSet* ws,
+                           std::vector<WorkingSetID>* batch,
+                           WorkingSetID* out) final;
     bool isEOF() final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
@@ -80,12 +93,51 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Called when '_cursor' has no more records. A tailable scan which has already returned
+     * records drops its cursor so that it can pick up where it left off; any other scan is over.
+     */
+    void handleEndOfCursor();
+
+    /**
+     * Puts 'record', just read from '_cursor', in a new working set member and returns its id.
+     */
+    WorkingSetID allocateMember(Record* record);
+
+    /**
+     * Returns true if the filter should be applied on several threads at once. See
+     * internalQueryCollScanFilterThreads.
+     */
+    bool canFilterInParallel() const;
+
+    /**
+     * Applies the filter to '_unfilteredRecords' using '_parallelFilter', and appends the records
+     * that match to '_matchedRecords' in the order they were read.
+     */
+    void filterBufferedRecords();
+
+    /**
+     * Puts the first record of '_matchedRecords' in the working set, sets *out to its id and
+     * returns ADVANCED.
+     */
+    StageState returnNextMatched(WorkingSetID* out);
+
+    // A document read from the collection when the filter is applied in parallel.
+    struct BufferedRecord {
+        RecordId id;
+        SnapshotId snapshotId;
+        BSONObj obj;
+    };
+
     // WorkingSet is not owned by us.
     WorkingSet* _workingSet;
 
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Compiled from '_filter' if internalQueryCompileFilters is set and compiling is worthwhile.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
     std::unique_ptr<SeekableRecordCursor> _cursor;
 
     CollectionScanParams _params;
@@ -101,6 +153,18 @@ private:
 
     // Stats
     CollectionScanStats _specificStats;
+
+    //
+    // Used when the filter is applied in parallel. Records are read ahead of the filter into
+    // '_unfilteredRecords', filtered a batch at a time, and then returned from '_matchedRecords'.
+    //
+
+    std::unique_ptr<ParallelFilter> _parallelFilter;
+
+    std::vector<BufferedRecord> _unfilteredRecords;
+    size_t _unfilteredBytes = 0;
+
+    std::deque<BufferedRecord> _matchedRecords;
 };
 
 }  // namespace mongo
@@ -59,6 +59,11 @@ struct CollectionScanParams {
 
     // If non-zero, how many documents will we look at?
     size_t maxScan = 0;
+
+    // May the scan read ahead of its consumer to filter records on the shared ParallelFilter
+    // worker pool? Only set this when every record of the scan will be read, i.e. when nothing
+    // above it stops early.
+    bool allowParallelFilter = false;
 };
 
 }  // namespace mongo
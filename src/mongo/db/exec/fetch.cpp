@@ -35,6 +35,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -60,6 +61,10 @@ FetchStage::FetchStage(OperationContext* opCtx,
       _filter(filter),
       _idRetrying(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
+
+    if (_filter && internalQueryCompileFilters.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
 }
 
 FetchStage::~FetchStage() {}
@@ -71,6 +76,10 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_idsToFetch.empty()) {
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -79,59 +88,124 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
-    // Either retry the last WSM we worked on or get a new one from our child.
+    // Either retry the last WSM we worked on, or fetch one our child has already returned, or get
+    // a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (!_idsToFetch.empty()) {
+        status = ADVANCED;
+        id = _idsToFetch.front();
+        _idsToFetch.pop_front();
+    } else {
+        status = child()->work(&id);
     }
 
     if (PlanStage::ADVANCED == status) {
-        WorkingSetMember* member = _ws->get(id);
+        return fetchAndMatch(id, out);
+    }
+    return returnChildState(status, id, out);
+}
+
+PlanStage::StageState FetchStage::doWorkBatch(size_t maxWork,
+                                              WorkingSet* ws,
+                                              std::vector<WorkingSetID>* batch,
+                                              WorkingSetID* out) {
+    if (isEOF()) {
+        return PlanStage::IS_EOF;
+    }
 
-        // If there's an obj there, there is no fetching to perform.
-        if (member->hasObj()) {
-            ++_specificStats.alreadyHasObj;
+    // Take a batch of record ids from our child, unless some are still left from the last one.
+    if (_idRetrying == WorkingSet::INVALID_ID && _idsToFetch.empty()) {
+        std::vector<WorkingSetID> childBatch;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = child()->workBatch(maxWork, ws, &childBatch, &id);
+        if (PlanStage::ADVANCED != status) {
+            return returnChildState(status, id, out);
+        }
+        _idsToFetch.insert(_idsToFetch.end(), childBatch.begin(), childBatch.end());
+    }
+
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < maxWork && batchBytes <= kMaxWorkBatchBytes; ++i) {
+        WorkingSetID id;
+        if (_idRetrying != WorkingSet::INVALID_ID) {
+            id = _idRetrying;
+            _idRetrying = WorkingSet::INVALID_ID;
+        } else if (!_idsToFetch.empty()) {
+            id = _idsToFetch.front();
+            _idsToFetch.pop_front();
         } else {
-            // We need a valid RecordId to fetch from and this is the only state that has one.
-            verify(WorkingSetMember::RID_AND_IDX == member->getState());
-            verify(member->hasRecordId());
-
-            try {
-                if (!_cursor)
-                    _cursor = _collection->getCursor(getOpCtx());
-
-                if (auto fetcher = _cursor->fetcherForId(member->recordId)) {
-                    // There's something to fetch. Hand the fetcher off to the WSM, and pass up
-                    // a fetch request.
-                    _idRetrying = id;
-                    member->setFetcher(fetcher.release());
-                    *out = id;
-                    return NEED_YIELD;
-                }
-
-                // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
-                // as well as an unowned object
-                if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor)) {
-                    _ws->free(id);
-                    return NEED_TIME;
-                }
-            } catch (const WriteConflictException&) {
-                // Ensure that the BSONObj underlying the WorkingSetMember is owned because it may
-                // be freed when we yield.
-                member->makeObjOwnedIfNeeded();
+            break;
+        }
+
+        WorkingSetID resultId = WorkingSet::INVALID_ID;
+        StageState state = fetchAndMatch(id, &resultId);
+        if (PlanStage::ADVANCED == state) {
+            // The next fetch may move the cursor this result's record points into.
+            WorkingSetMember* member = _ws->get(resultId);
+            member->makeObjOwnedIfNeeded();
+            batchBytes += member->getMemUsage();
+            batch->push_back(resultId);
+        } else if (PlanStage::NEED_TIME != state) {
+            *out = resultId;
+            return state;
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
+PlanStage::StageState FetchStage::fetchAndMatch(WorkingSetID id, WorkingSetID* out) {
+    WorkingSetMember* member = _ws->get(id);
+
+    // If there's an obj there, there is no fetching to perform.
+    if (member->hasObj()) {
+        ++_specificStats.alreadyHasObj;
+    } else {
+        // We need a valid RecordId to fetch from and this is the only state that has one.
+        verify(WorkingSetMember::RID_AND_IDX == member->getState());
+        verify(member->hasRecordId());
+
+        try {
+            if (!_cursor)
+                _cursor = _collection->getCursor(getOpCtx());
+
+            if (auto fetcher = _cursor->fetcherForId(member->recordId)) {
+                // There's something to fetch. Hand the fetcher off to the WSM, and pass up
+                // a fetch request.
                 _idRetrying = id;
-                *out = WorkingSet::INVALID_ID;
+                member->setFetcher(fetcher.release());
+                *out = id;
                 return NEED_YIELD;
             }
+
+            // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
+            // as well as an unowned object
+            if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor)) {
+                _ws->free(id);
+                return NEED_TIME;
+            }
+        } catch (const WriteConflictException&) {
+            // Ensure that the BSONObj underlying the WorkingSetMember is owned because it may
+            // be freed when we yield.
+            member->makeObjOwnedIfNeeded();
+            _idRetrying = id;
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
         }
+    }
 
-        return returnIfMatches(member, id, out);
-    } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+    return returnIfMatches(member, id, out);
+}
+
+PlanStage::StageState FetchStage::returnChildState(StageState status,
+                                                   WorkingSetID id,
+                                                   WorkingSetID* out) {
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
         *out = id;
         // If a stage fails, it may create a status WSM to indicate why it
         // failed, in which case 'id' is valid.  If ID is invalid, we
@@ -180,6 +254,14 @@ void FetchStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Inval
             WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
         }
     }
+
+    // The same goes for the record ids our child has returned which we have not fetched yet.
+    for (auto id : _idsToFetch) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        }
+    }
 }
 
 PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
@@ -201,7 +283,7 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     // predicate.
     ++_specificStats.docsExamined;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         *out = memberID;
         return PlanStage::ADVANCED;
     } else {
@@ -28,10 +28,12 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 
@@ -59,6 +61,10 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWork,
+                           WorkingSet* ws,
+                           std::vector<WorkingSetID>* batch,
+                           WorkingSetID* out) final;
 
     void doSaveState() final;
     void doRestoreState() final;
@@ -77,6 +83,18 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Fetches the document of the member with id 'id', which our child returned, and passes it
+     * through returnIfMatches(). Returns NEED_YIELD if the document has to be paged in first or a
+     * write conflict occurred, in which case the member is retried by the next call.
+     */
+    StageState fetchAndMatch(WorkingSetID id, WorkingSetID* out);
+
+    /**
+     * Passes up 'status', a state other than ADVANCED which our child returned with 'id'.
+     */
+    StageState returnChildState(StageState status, WorkingSetID id, WorkingSetID* out);
+
     /**
      * If the member (with id memberID) passes our filter, set *out to memberID and return that
      * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
@@ -95,9 +113,16 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Compiled from '_filter' if internalQueryCompileFilters is set and compiling is worthwhile.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Results of our child's last batch which have not been fetched yet. They are fetched before
+    // asking our child for more, but after '_idRetrying'.
+    std::deque<WorkingSetID> _idsToFetch;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -35,11 +35,13 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/parallel_filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -52,6 +54,11 @@ int sgn(int i) {
     return i > 0 ? 1 : -1;
 }
 
+// When the filter is applied in parallel, a batch is filtered once it has this many keys or this
+// many bytes of keys, whichever comes first.
+const size_t kMaxKeysPerFilterBatch = 1024;
+const size_t kMaxBytesPerFilterBatch = 16 * 1024 * 1024;
+
 }  // namespace
 
 namespace mongo {
@@ -88,8 +95,16 @@ IndexScan::IndexScan(OperationContext* opCtx,
     _specificStats.isSparse = _params.descriptor->isSparse();
     _specificStats.isPartial = _params.descriptor->isPartial();
     _specificStats.indexVersion = static_cast<int>(_params.descriptor->version());
+
+    const int numFilterThreads = internalQueryIndexScanFilterThreads.load();
+    if (_params.allowParallelFilter && numFilterThreads > 0 &&
+        ParallelFilter::canApply(getOpCtx(), _filter)) {
+        _parallelFilter = stdx::make_unique<ParallelFilter>(numFilterThreads);
+    }
 }
 
+IndexScan::~IndexScan() = default;
+
 boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
     if (_params.doNotDedup) {
         _shouldDedup = false;
@@ -129,29 +144,125 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
     }
 }
 
+void IndexScan::filterBufferedKeys() {
+    const size_t numKeys = _unfilteredKeys.size();
+    if (0 == numKeys) {
+        return;
+    }
+
+    // Don't use std::vector<bool>, whose elements can't be written from different threads.
+    std::vector<char> matches(numKeys, false);
+    _parallelFilter->run(
+        [this](size_t i) { return Filter::passes(_unfilteredKeys[i].key, _keyPattern, _filter); },
+        &matches);
+
+    for (size_t i = 0; i < numKeys; ++i) {
+        if (matches[i]) {
+            _matchedKeys.push_back(std::move(_unfilteredKeys[i]));
+        }
+    }
+    _unfilteredKeys.clear();
+    _unfilteredBytes = 0;
+}
+
+PlanStage::StageState IndexScan::returnKey(const BSONObj& key,
+                                           const RecordId& loc,
+                                           WorkingSetID* out) {
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = loc;
+    member->keyData.push_back(IndexKeyDatum(_keyPattern, key, _iam));
+    _workingSet->transitionToRecordIdAndIdx(id);
+
+    if (_params.addKeyMetadata) {
+        BSONObjBuilder bob;
+        bob.appendKeys(_keyPattern, key);
+        member->addComputed(new IndexKeyComputedData(bob.obj()));
+    }
+
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
 PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
+    // Return keys the parallel filter has already accepted before reading more of the index.
+    if (!_matchedKeys.empty()) {
+        IndexKeyEntry entry = std::move(_matchedKeys.front());
+        _matchedKeys.pop_front();
+        return returnKey(entry.key, entry.loc, out);
+    }
+
+    if (HIT_END == _scanState) {
+        return PlanStage::IS_EOF;
+    }
+
     // Get the next kv pair from the index, if any.
     boost::optional<IndexKeyEntry> kv;
     try {
-        switch (_scanState) {
-            case INITIALIZING:
-                kv = initIndexScan();
-                break;
-            case GETTING_NEXT:
-                kv = _indexCursor->next();
-                break;
-            case NEED_SEEK:
-                ++_specificStats.seeks;
-                kv = _indexCursor->seek(_seekPoint);
-                break;
-            case HIT_END:
-                return PlanStage::IS_EOF;
-        }
+        kv = readNextKey();
     } catch (const WriteConflictException&) {
         *out = WorkingSet::INVALID_ID;
         return PlanStage::NEED_YIELD;
     }
 
+    return processKey(std::move(kv), out);
+}
+
+PlanStage::StageState IndexScan::doWorkBatch(size_t maxWork,
+                                             WorkingSet* ws,
+                                             std::vector<WorkingSetID>* batch,
+                                             WorkingSetID* out) {
+    // Keys read ahead for the parallel filter are buffered and returned by doWork().
+    if (_parallelFilter) {
+        return PlanStage::doWorkBatch(maxWork, ws, batch, out);
+    }
+
+    // The keys of the results are owned, so nothing has to be copied before reading on.
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < maxWork && batchBytes <= kMaxWorkBatchBytes; ++i) {
+        if (HIT_END == _scanState) {
+            return PlanStage::IS_EOF;
+        }
+
+        boost::optional<IndexKeyEntry> kv;
+        try {
+            kv = readNextKey();
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = processKey(std::move(kv), &id);
+        if (PlanStage::ADVANCED == state) {
+            batchBytes += _workingSet->get(id)->getMemUsage();
+            batch->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            *out = id;
+            return state;
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
+boost::optional<IndexKeyEntry> IndexScan::readNextKey() {
+    switch (_scanState) {
+        case INITIALIZING:
+            return initIndexScan();
+        case GETTING_NEXT:
+            return _indexCursor->next();
+        case NEED_SEEK:
+            ++_specificStats.seeks;
+            return _indexCursor->seek(_seekPoint);
+        case HIT_END:
+            break;
+    }
+    MONGO_UNREACHABLE;
+}
+
+PlanStage::StageState IndexScan::processKey(boost::optional<IndexKeyEntry> kv,
+                                            WorkingSetID* out) {
     if (kv) {
         // In debug mode, check that the cursor isn't lying to us.
         if (kDebugBuild && !_startKey.isEmpty()) {
@@ -197,6 +308,11 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
         _scanState = HIT_END;
         _commonStats.isEOF = true;
         _indexCursor.reset();
+
+        if (!_unfilteredKeys.empty()) {
+            filterBufferedKeys();
+            return PlanStage::NEED_TIME;
+        }
         return PlanStage::IS_EOF;
     }
 
@@ -211,6 +327,16 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
         }
     }
 
+    if (_parallelFilter) {
+        _unfilteredBytes += kv->key.objsize();
+        _unfilteredKeys.push_back({kv->key.getOwned(), kv->loc});
+        if (_unfilteredKeys.size() >= kMaxKeysPerFilterBatch ||
+            _unfilteredBytes >= kMaxBytesPerFilterBatch) {
+            filterBufferedKeys();
+        }
+        return PlanStage::NEED_TIME;
+    }
+
     if (_filter) {
         if (!Filter::passes(kv->key, _keyPattern, _filter)) {
             return PlanStage::NEED_TIME;
@@ -221,24 +347,11 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
         kv->key = kv->key.getOwned();
 
     // We found something to return, so fill out the WSM.
-    WorkingSetID id = _workingSet->allocate();
-    WorkingSetMember* member = _workingSet->get(id);
-    member->recordId = kv->loc;
-    member->keyData.push_back(IndexKeyDatum(_keyPattern, kv->key, _iam));
-    _workingSet->transitionToRecordIdAndIdx(id);
-
-    if (_params.addKeyMetadata) {
-        BSONObjBuilder bob;
-        bob.appendKeys(_keyPattern, kv->key);
-        member->addComputed(new IndexKeyComputedData(bob.obj()));
-    }
-
-    *out = id;
-    return PlanStage::ADVANCED;
+    return returnKey(kv->key, kv->loc, out);
 }
 
 bool IndexScan::isEOF() {
-    return _commonStats.isEOF;
+    return _commonStats.isEOF && _matchedKeys.empty();
 }
 
 void IndexScan::doSaveState() {
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/index/index_access_method.h"
@@ -43,11 +46,17 @@ namespace mongo {
 
 class IndexAccessMethod;
 class IndexDescriptor;
+class ParallelFilter;
 class WorkingSet;
 
 struct IndexScanParams {
     IndexScanParams()
-        : descriptor(NULL), direction(1), doNotDedup(false), maxScan(0), addKeyMetadata(false) {}
+        : descriptor(NULL),
+          direction(1),
+          doNotDedup(false),
+          maxScan(0),
+          addKeyMetadata(false),
+          allowParallelFilter(false) {}
 
     const IndexDescriptor* descriptor;
 
@@ -62,6 +71,11 @@ struct IndexScanParams {
 
     // Do we want to add the key as metadata?
     bool addKeyMetadata;
+
+    // May the scan read keys ahead of its consumer to filter them on the shared ParallelFilter
+    // worker pool? Only set this when every key in the bounds will be read, i.e. when nothing
+    // above it stops early.
+    bool allowParallelFilter;
 };
 
 /**
@@ -95,7 +109,13 @@ public:
               WorkingSet* workingSet,
               const MatchExpression* filter);
 
+    ~IndexScan();
+
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWork,
+                           WorkingSet* ws,
+                           std::vector<WorkingSetID>* batch,
+                           WorkingSetID* out) final;
     bool isEOF() final;
     void doSaveState() final;
     void doRestoreState() final;
@@ -119,6 +139,32 @@ private:
      */
     boost::optional<IndexKeyEntry> initIndexScan();
 
+    /**
+     * Reads the next entry from the index as '_scanState' directs, or returns boost::none if
+     * there is none. Must not be called once the scan has hit its end. May throw
+     * WriteConflictException.
+     */
+    boost::optional<IndexKeyEntry> readNextKey();
+
+    /**
+     * Decides what to do with 'kv', the entry just returned by readNextKey(): ends the scan if it
+     * is out of bounds or missing, or skips it if it is a duplicate or does not match the filter.
+     * Returns ADVANCED with *out set if the key is returned.
+     */
+    StageState processKey(boost::optional<IndexKeyEntry> kv, WorkingSetID* out);
+
+    /**
+     * Puts 'key' and 'loc' in a new working set member, sets *out to its id and returns
+     * ADVANCED. 'key' must be owned.
+     */
+    StageState returnKey(const BSONObj& key, const RecordId& loc, WorkingSetID* out);
+
+    /**
+     * Applies the filter to '_unfilteredKeys' using '_parallelFilter', and appends the keys that
+     * match to '_matchedKeys' in the order they were read.
+     */
+    void filterBufferedKeys();
+
     // The WorkingSet we fill with results.  Not owned by us.
     WorkingSet* const _workingSet;
 
@@ -174,6 +220,19 @@ private:
     bool _startKeyInclusive;
     // Is the end key included in the range?
     bool _endKeyInclusive;
+
+    //
+    // Used when the filter is applied in parallel, see internalQueryIndexScanFilterThreads. Keys
+    // are read ahead of the filter into '_unfilteredKeys', filtered a batch at a time, and then
+    // returned from '_matchedKeys'.
+    //
+
+    std::unique_ptr<ParallelFilter> _parallelFilter;
+
+    std::vector<IndexKeyEntry> _unfilteredKeys;
+    size_t _unfilteredBytes = 0;
+
+    std::deque<IndexKeyEntry> _matchedKeys;
 };
 
 }  // namespace mongo
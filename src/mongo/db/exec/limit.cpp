@@ -86,6 +86,33 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::doWorkBatch(size_t maxWork,
+                                              WorkingSet* ws,
+                                              vector<WorkingSetID>* batch,
+                                              WorkingSetID* out) {
+    if (0 == _numToReturn) {
+        // We've returned as many results as we're limited to.
+        return PlanStage::IS_EOF;
+    }
+
+    // The child produces at most one result per unit of work, so bounding its work by the number
+    // of results left to return keeps it from producing results we would have to discard.
+    const size_t batchStart = batch->size();
+    StageState status = child()->workBatch(
+        std::min(maxWork, static_cast<size_t>(_numToReturn)), ws, batch, out);
+    _numToReturn -= batch->size() - batchStart;
+
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == *out) {
+        mongoutils::str::stream ss;
+        ss << "limit stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
@@ -0,0 +1,180 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_filter.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "mongo/db/client.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+namespace {
+
+ThreadPool* getWorkerPool() {
+    static ThreadPool* const pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "ParallelFilter";
+        options.minThreads = 0;
+        options.maxThreads = ParallelFilter::kMaxPoolThreads;
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+        };
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return pool;
+}
+
+/**
+ * The ranges a batch is split into, claimed one at a time by the calling thread and the pool
+ * tasks. A task may only start once the call has returned, in which case it finds no range left
+ * to claim and never calls 'filterRange', whose captures are gone by then.
+ */
+class FilterRanges {
+    MONGO_DISALLOW_COPYING(FilterRanges);
+
+public:
+    FilterRanges(size_t numRanges, stdx::function<void(size_t)> filterRange)
+        : _numRanges(numRanges), _filterRange(std::move(filterRange)) {}
+
+    /**
+     * Filters ranges until there are none left to claim.
+     */
+    void filterUnclaimedRanges() {
+        while (true) {
+            size_t range;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_nextRange == _numRanges) {
+                    return;
+                }
+                range = _nextRange++;
+                ++_numInProgress;
+            }
+
+            ON_BLOCK_EXIT([&] {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (0 == --_numInProgress) {
+                    _noneInProgress.notify_all();
+                }
+            });
+            _filterRange(range);
+        }
+    }
+
+    /**
+     * Stops any more ranges from being claimed and waits for those being filtered.
+     */
+    void finish() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _nextRange = _numRanges;
+        _noneInProgress.wait(lk, [&] { return 0 == _numInProgress; });
+    }
+
+private:
+    const size_t _numRanges;
+    const stdx::function<void(size_t)> _filterRange;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _noneInProgress;
+    size_t _nextRange = 0;
+    size_t _numInProgress = 0;
+};
+
+}  // namespace
+
+const size_t ParallelFilter::kMaxPoolThreads = 64;
+
+// static
+bool ParallelFilter::canApply(OperationContext* opCtx, const MatchExpression* filter) {
+    if (!filter) {
+        return false;
+    }
+
+    // Items read ahead of the filter are not in the working set, so they would miss the
+    // invalidations that storage engines without document-level locking rely on.
+    if (!opCtx->getServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+        return false;
+    }
+
+    // These expressions keep per-query state while matching and cannot be used from several
+    // threads.
+    for (auto type : {MatchExpression::WHERE, MatchExpression::TEXT, MatchExpression::GEO_NEAR}) {
+        if (QueryPlannerCommon::hasNode(filter, type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ParallelFilter::ParallelFilter(size_t numThreads) : _numThreads(numThreads) {}
+
+ParallelFilter::~ParallelFilter() = default;
+
+void ParallelFilter::run(const stdx::function<bool(size_t)>& matchesItem,
+                         std::vector<char>* matches) {
+    const size_t numItems = matches->size();
+
+    // Split the items into one range per worker thread plus one for this thread.
+    const size_t numRanges = std::max<size_t>(1, std::min(numItems, _numThreads + 1));
+    const size_t itemsPerRange = (numItems + numRanges - 1) / numRanges;
+
+    auto ranges = std::make_shared<FilterRanges>(numRanges, [&](size_t range) {
+        const size_t end = std::min(numItems, (range + 1) * itemsPerRange);
+        for (size_t i = range * itemsPerRange; i < end; ++i) {
+            (*matches)[i] = matchesItem(i);
+        }
+    });
+
+    // The pool threads use this function's locals, so wait for them even if this thread throws.
+    ON_BLOCK_EXIT([&] { ranges->finish(); });
+
+    // Whatever the pool has not started on is filtered by this thread, so the scan never waits for
+    // tasks queued behind those of other scans.
+    for (size_t i = 1; i < numRanges; ++i) {
+        if (!getWorkerPool()->schedule([ranges] { ranges->filterUnclaimedRanges(); }).isOK()) {
+            break;
+        }
+    }
+    ranges->filterUnclaimedRanges();
+}
+
+}  // namespace mongo
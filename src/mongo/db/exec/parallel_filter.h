@@ -0,0 +1,85 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/functional.h"
+
+namespace mongo {
+
+class MatchExpression;
+class OperationContext;
+
+/**
+ * Applies a filter to a batch of documents or index keys, splitting the batch between the calling
+ * thread and a pool of worker threads. Used by scan stages that read ahead of their filter; the
+ * stage keeps reading on its own thread and only the matching is done in parallel.
+ *
+ * The worker threads come from a pool shared by all parallel filters in the process, which has at
+ * most kMaxPoolThreads threads and lets idle ones exit, so scans of cursors waiting for a getMore
+ * do not hold on to any threads.
+ */
+class ParallelFilter {
+    MONGO_DISALLOW_COPYING(ParallelFilter);
+
+public:
+    /**
+     * The most threads the shared worker pool runs at once.
+     */
+    static const size_t kMaxPoolThreads;
+
+    /**
+     * Returns true if 'filter' can be matched from several threads at once by a scan running in
+     * 'opCtx'.
+     */
+    static bool canApply(OperationContext* opCtx, const MatchExpression* filter);
+
+    /**
+     * 'numThreads' is the number of worker threads, in addition to the calling thread, each batch
+     * is split between.
+     */
+    explicit ParallelFilter(size_t numThreads);
+
+    ~ParallelFilter();
+
+    /**
+     * Sets the i-th entry of 'matches' to 'matchesItem(i)' for every i less than
+     * matches->size(). 'matchesItem' is called concurrently from several threads and must be
+     * safe to call that way.
+     */
+    void run(const stdx::function<bool(size_t)>& matchesItem, std::vector<char>* matches);
+
+private:
+    const size_t _numThreads;
+};
+
+}  // namespace mongo
@@ -40,6 +40,12 @@ namespace mongo {
 
 PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     invariant(_opCtx);
+    if (_hasStashedState) {
+        _hasStashedState = false;
+        *out = _stashedId;
+        return _stashedState;
+    }
+
     ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
     ++_commonStats.works;
 
@@ -56,6 +62,80 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     return workResult;
 }
 
+// static
+const size_t PlanStage::kMaxWorkBatchBytes = 4 * 1024 * 1024;
+
+PlanStage::StageState PlanStage::workBatch(size_t maxWork,
+                                           WorkingSet* ws,
+                                           std::vector<WorkingSetID>* batch,
+                                           WorkingSetID* out) {
+    invariant(_opCtx);
+    invariant(maxWork > 0);
+    if (_hasStashedState) {
+        _hasStashedState = false;
+        *out = _stashedId;
+        return _stashedState;
+    }
+
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+    const size_t batchStart = batch->size();
+
+    StageState workResult = doWorkBatch(maxWork, ws, batch, out);
+
+    if (StageState::ADVANCED == workResult) {
+        workResult = StageState::NEED_TIME;
+    }
+
+    // Count a unit of work for every result, plus one for the state which ended the batch unless
+    // the batch simply ran out of work after producing results.
+    const size_t numResults = batch->size() - batchStart;
+    _commonStats.advanced += numResults;
+    _commonStats.works += numResults;
+    if (numResults == 0 || StageState::NEED_TIME != workResult) {
+        ++_commonStats.works;
+        if (StageState::NEED_TIME == workResult) {
+            ++_commonStats.needTime;
+        } else if (StageState::NEED_YIELD == workResult) {
+            ++_commonStats.needYield;
+        }
+    }
+
+    if (numResults == 0) {
+        return workResult;
+    }
+
+    if (StageState::ADVANCED != workResult && StageState::NEED_TIME != workResult) {
+        _hasStashedState = true;
+        _stashedState = workResult;
+        _stashedId = *out;
+    }
+    *out = WorkingSet::INVALID_ID;
+    return StageState::ADVANCED;
+}
+
+PlanStage::StageState PlanStage::doWorkBatch(size_t maxWork,
+                                             WorkingSet* ws,
+                                             std::vector<WorkingSetID>* batch,
+                                             WorkingSetID* out) {
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < maxWork && batchBytes <= kMaxWorkBatchBytes; ++i) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState workResult = doWork(&id);
+        if (StageState::ADVANCED == workResult) {
+            // The next call to doWork() may move the cursor this result's record points into.
+            WorkingSetMember* member = ws->get(id);
+            member->makeObjOwnedIfNeeded();
+            batchBytes += member->getMemUsage();
+            batch->push_back(id);
+        } else if (StageState::NEED_TIME != workResult) {
+            *out = id;
+            return workResult;
+        }
+    }
+
+    return StageState::NEED_TIME;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
@@ -188,6 +188,29 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * Performs up to 'maxWork' units of work on the query in one call, appending the ID of every
+     * result produced to 'batch'.  Returns ADVANCED if at least one result was appended.
+     * Otherwise, returns the state which ended the batch, with *out set as work() would set it.
+     *
+     * The results are members of 'ws', which must be the working set the stage was built with.
+     * Their documents are owned, since the records of earlier results may be freed by the storage
+     * engine as later ones are read.  A batch also ends early once its results use more than
+     * kMaxWorkBatchBytes.
+     *
+     * A state other than ADVANCED or NEED_TIME which is reached after some results have already
+     * been appended is returned by the next call to workBatch() or work() instead, so callers see
+     * the same sequence of states as they would by calling work() repeatedly.  Nothing must be
+     * done to the stage in between, other than consuming the results of the batch.
+     */
+    StageState workBatch(size_t maxWork,
+                         WorkingSet* ws,
+                         std::vector<WorkingSetID>* batch,
+                         WorkingSetID* out);
+
+    // The memory the results of a single call to workBatch() may use before the batch ends.
+    static const size_t kMaxWorkBatchBytes;
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -347,6 +370,21 @@ protected:
      */
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs up to 'maxWork' units of work, appending results to 'batch'.  Stops early at the
+     * first state other than ADVANCED or NEED_TIME, which it returns with *out set.  Returns
+     * NEED_TIME if it stopped because it ran out of units of work.
+     *
+     * Stages which can process many results at a time more cheaply than one per doWork() should
+     * override this, and must keep the guarantees of workBatch() about owned documents and
+     * kMaxWorkBatchBytes.  The default implementation calls doWork() repeatedly, making each
+     * result's document owned before doing more work.
+     */
+    virtual StageState doWorkBatch(size_t maxWork,
+                                   WorkingSet* ws,
+                                   std::vector<WorkingSetID>* batch,
+                                   WorkingSetID* out);
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
@@ -397,6 +435,12 @@ protected:
 
 private:
     OperationContext* _opCtx;
+
+    // Set by workBatch() when it reached a state other than ADVANCED or NEED_TIME after having
+    // produced results. That state and its WorkingSetID are returned by the next call for work.
+    bool _hasStashedState = false;
+    StageState _stashedState = NEED_TIME;
+    WorkingSetID _stashedId = WorkingSet::INVALID_ID;
 };
 
 }  // namespace mongo
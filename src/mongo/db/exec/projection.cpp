@@ -94,6 +94,7 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
                     // If we are including this key field store its field name.
                     _keyFieldNames.push_back(fieldIt->first);
                     _includeKey.push_back(true);
+                    _numKeyFieldsToScan = _includeKey.size();
                 }
             }
         } else {
@@ -102,6 +103,17 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
     }
 }
 
+namespace {
+
+void addIncludedField(StringData fieldName, ProjectionStage::FieldSet* includedFields) {
+    if (includedFields->end() == includedFields->find(fieldName)) {
+        const size_t position = includedFields->size();
+        (*includedFields)[fieldName] = position;
+    }
+}
+
+}  // namespace
+
 // static
 void ProjectionStage::getSimpleInclusionFields(const BSONObj& projObj, FieldSet* includedFields) {
     // The _id is included by default.
@@ -118,11 +130,11 @@ void ProjectionStage::getSimpleInclusionFields(const BSONObj& projObj, FieldSet*
             includeId = false;
             continue;
         }
-        (*includedFields)[elt.fieldNameStringData()] = true;
+        addIncludedField(elt.fieldNameStringData(), includedFields);
     }
 
     if (includeId) {
-        (*includedFields)[kIdField] = true;
+        addIncludedField(kIdField, includedFields);
     }
 }
 
@@ -130,15 +142,43 @@ void ProjectionStage::getSimpleInclusionFields(const BSONObj& projObj, FieldSet*
 void ProjectionStage::transformSimpleInclusion(const BSONObj& in,
                                                const FieldSet& includedFields,
                                                BSONObjBuilder& bob) {
-    // Look at every field in the source document and see if we're including it.
+    // Included fields that sit next to each other in the source document are also next to each
+    // other in the output, so rather than appending them one at a time we remember where the
+    // current run of included fields starts and copy the whole run with a single append.
+    const char* runStart = nullptr;
+    const char* runEnd = nullptr;
+
+    // Look at every field in the source document and see if we're including it. Once every
+    // included field has been seen there is no need to look at the rest of the document. We
+    // only track this when each included field fits in a bit of 'found'. Stored documents
+    // shouldn't repeat field names, so we accept that a repeated field after this point is
+    // dropped.
+    const bool canStopEarly = includedFields.size() < 64;
+    const uint64_t allFound = canStopEarly ? (uint64_t(1) << includedFields.size()) - 1 : 0;
+    uint64_t found = 0;
+
     BSONObjIterator inputIt(in);
-    while (inputIt.more()) {
+    while (inputIt.more() && (!canStopEarly || found != allFound)) {
         BSONElement elt = inputIt.next();
         auto fieldIt = includedFields.find(elt.fieldNameStringData());
-        if (includedFields.end() != fieldIt) {
-            // If so, add it to the builder.
-            bob.append(elt);
+        if (includedFields.end() == fieldIt) {
+            continue;
         }
+
+        if (canStopEarly) {
+            found |= uint64_t(1) << fieldIt->second;
+        }
+        if (elt.rawdata() != runEnd) {
+            if (runStart) {
+                bob.bb().appendBuf(runStart, runEnd - runStart);
+            }
+            runStart = elt.rawdata();
+        }
+        runEnd = elt.rawdata() + elt.size();
+    }
+
+    if (runStart) {
+        bob.bb().appendBuf(runStart, runEnd - runStart);
     }
 }
 
@@ -168,9 +208,9 @@ Status ProjectionStage::transform(WorkingSetMember* member) {
         invariant(1 == member->keyData.size());
         size_t keyIndex = 0;
 
-        // Look at every key element...
+        // Look at every key element up to the last one we include...
         BSONObjIterator keyIterator(member->keyData[0].keyData);
-        while (keyIterator.more()) {
+        while (keyIterator.more() && keyIndex < _numKeyFieldsToScan) {
             BSONElement elt = keyIterator.next();
             // If we're supposed to include it...
             if (_includeKey[keyIndex]) {
@@ -227,6 +267,38 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxWork,
+                                                   WorkingSet* ws,
+                                                   vector<WorkingSetID>* batch,
+                                                   WorkingSetID* out) {
+    const size_t batchStart = batch->size();
+    StageState status = child()->workBatch(maxWork, ws, batch, out);
+
+    for (size_t i = batchStart; i < batch->size(); ++i) {
+        Status projStatus = transform(_ws->get((*batch)[i]));
+        if (!projStatus.isOK()) {
+            warning() << "Couldn't execute projection, status = " << redact(projStatus);
+            // Calling doWork() would have stopped at this result, so drop it and those after it.
+            for (size_t j = i; j < batch->size(); ++j) {
+                _ws->free((*batch)[j]);
+            }
+            batch->resize(i);
+            *out = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+            return PlanStage::FAILURE;
+        }
+    }
+
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == *out) {
+        mongoutils::str::stream ss;
+        ss << "projection stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_PROJECTION);
@@ -88,6 +88,10 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWork,
+                           WorkingSet* ws,
+                           std::vector<WorkingSetID>* batch,
+                           WorkingSetID* out) final;
 
     StageType stageType() const final {
         return STAGE_PROJECTION;
@@ -97,7 +101,8 @@ public:
 
     const SpecificStats* getSpecificStats() const final;
 
-    using FieldSet = StringMap<bool>;  // Value is unused.
+    // Maps each field name to its position in the projection, starting from zero.
+    using FieldSet = StringMap<size_t>;
 
     /**
      * Given the projection spec for a simple inclusion projection,
@@ -108,7 +113,10 @@ public:
 
     /**
      * Applies a simple inclusion projection to 'in', including
-     * only the fields specified by 'includedFields'.
+     * only the fields specified by 'includedFields'. Stops reading 'in'
+     * once each of the included fields has been found, so unlike
+     * ProjectionExec, a field whose name repeats an included field is
+     * left out if it comes after that point.
      *
      * The resulting document is constructed using 'bob'.
      */
@@ -150,6 +158,10 @@ private:
 
     // If the i-th entry of _includeKey is true this is the field name for the i-th key field.
     std::vector<StringData> _keyFieldNames;
+
+    // The number of leading key fields we need to look at, i.e. one past the index of the last
+    // key field we include. Key fields after it are never part of the result.
+    size_t _numKeyFieldsToScan = 0;
 };
 
 }  // namespace mongo
@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+//
+// This file contains tests for mongo/db/exec/projection.cpp
+//
+
+#include "mongo/db/exec/projection.h"
+
+#include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/service_context_noop.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source_mock.h"
+
+using namespace mongo;
+
+namespace {
+
+using stdx::make_unique;
+
+BSONObj applySimpleInclusion(const char* projSpec, const BSONObj& in) {
+    ProjectionStage::FieldSet includedFields;
+    ProjectionStage::getSimpleInclusionFields(fromjson(projSpec), &includedFields);
+    BSONObjBuilder bob;
+    ProjectionStage::transformSimpleInclusion(in, includedFields, bob);
+    return bob.obj();
+}
+
+TEST(ProjectionStageSimpleInclusionTest, IncludedFieldsKeepDocumentOrder) {
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{_id: 1, b: 3, d: 5}"),
+        applySimpleInclusion("{d: 1, b: 1}", fromjson("{_id: 1, a: 2, b: 3, c: 4, d: 5}")));
+}
+
+TEST(ProjectionStageSimpleInclusionTest, AdjacentIncludedFieldsAreCopiedAsOneRun) {
+    // The runs {a, b} and {d, e} are each copied with one append, they must not be merged across
+    // the excluded field 'c'.
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{a: 1, b: 2, d: 4, e: 5}"),
+        applySimpleInclusion("{_id: 0, a: 1, b: 1, d: 1, e: 1}",
+                             fromjson("{a: 1, b: 2, c: 3, d: 4, e: 5}")));
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{a: 1, b: 2, c: 3}"),
+        applySimpleInclusion("{_id: 0, a: 1, b: 1, c: 1}", fromjson("{a: 1, b: 2, c: 3}")));
+}
+
+TEST(ProjectionStageSimpleInclusionTest, MissingIncludedFieldReadsWholeDocument) {
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{a: 1, c: 3}"),
+        applySimpleInclusion("{_id: 0, a: 1, c: 1, z: 1}", fromjson("{a: 1, b: 2, c: 3}")));
+}
+
+TEST(ProjectionStageSimpleInclusionTest, StopsOnceEveryIncludedFieldWasFound) {
+    // A repeated field name is only included if it comes before the last included field was
+    // found.
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 1, a: 2, b: 3}"),
+                      applySimpleInclusion("{_id: 0, a: 1, b: 1}", fromjson("{a: 1, a: 2, b: 3}")));
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 1, b: 2}"),
+                      applySimpleInclusion("{_id: 0, a: 1, b: 1}", fromjson("{a: 1, b: 2, a: 3}")));
+}
+
+class ProjectionStageCoveredTest : public unittest::Test {
+public:
+    ProjectionStageCoveredTest() {
+        _service = make_unique<ServiceContextNoop>();
+        _service->setFastClockSource(make_unique<ClockSourceMock>());
+        _client = _service->makeClient("test");
+        _opCtx = _client->makeOperationContext();
+    }
+
+protected:
+    /**
+     * Runs a COVERED_ONE_INDEX projection 'projSpec' over an index with key pattern 'keyPattern'
+     * on a single index key 'key', and returns the result.
+     */
+    BSONObj projectKey(const char* projSpec, const BSONObj& keyPattern, const BSONObj& key) {
+        WorkingSet ws;
+        auto queued = make_unique<QueuedDataStage>(_opCtx.get(), &ws);
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* member = ws.get(id);
+        member->keyData.push_back(IndexKeyDatum(keyPattern, key, nullptr));
+        ws.transitionToRecordIdAndIdx(id);
+        queued->pushBack(id);
+
+        ExtensionsCallbackNoop extensionsCallback;
+        ProjectionStageParams params(extensionsCallback);
+        params.projImpl = ProjectionStageParams::COVERED_ONE_INDEX;
+        params.projObj = fromjson(projSpec);
+        params.coveredKeyObj = keyPattern;
+        ProjectionStage projection(_opCtx.get(), params, &ws, queued.release());
+
+        WorkingSetID out = WorkingSet::INVALID_ID;
+        ASSERT_EQUALS(PlanStage::ADVANCED, projection.work(&out));
+        ASSERT_EQUALS(id, out);
+        return member->obj.value().getOwned();
+    }
+
+private:
+    // The UniqueClient must be destroyed before the ServiceContextNoop is destroyed.
+    // The OperationContext must be destroyed before the UniqueClient is destroyed.
+    std::unique_ptr<ServiceContextNoop> _service;
+    ServiceContext::UniqueClient _client;
+    ServiceContext::UniqueOperationContext _opCtx;
+};
+
+TEST_F(ProjectionStageCoveredTest, KeyFieldsAfterTheLastIncludedOneAreSkipped) {
+    const BSONObj keyPattern = BSON("a" << 1 << "b" << 1 << "c" << 1);
+    const BSONObj key = BSON("" << 1 << "" << 2 << "" << 3);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1), projectKey("{_id: 0, a: 1}", keyPattern, key));
+    ASSERT_BSONOBJ_EQ(BSON("b" << 2), projectKey("{_id: 0, b: 1}", keyPattern, key));
+}
+
+TEST_F(ProjectionStageCoveredTest, LastKeyFieldIsIncluded) {
+    const BSONObj keyPattern = BSON("a" << 1 << "b" << 1 << "c" << 1);
+    const BSONObj key = BSON("" << 1 << "" << 2 << "" << 3);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1 << "c" << 3),
+                      projectKey("{_id: 0, a: 1, c: 1}", keyPattern, key));
+}
+
+}  // namespace
@@ -87,6 +87,35 @@ PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState SkipStage::doWorkBatch(size_t maxWork,
+                                             WorkingSet* ws,
+                                             vector<WorkingSetID>* batch,
+                                             WorkingSetID* out) {
+    const size_t batchStart = batch->size();
+    StageState status = child()->workBatch(maxWork, ws, batch, out);
+
+    // Drop the results we're still skipping.
+    if (_toSkip > 0) {
+        const auto toDrop = std::min(static_cast<size_t>(_toSkip), batch->size() - batchStart);
+        auto dropEnd = batch->begin() + batchStart + toDrop;
+        for (auto it = batch->begin() + batchStart; it != dropEnd; ++it) {
+            _ws->free(*it);
+        }
+        batch->erase(batch->begin() + batchStart, dropEnd);
+        _toSkip -= toDrop;
+    }
+
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == *out) {
+        mongoutils::str::stream ss;
+        ss << "skip stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> SkipStage::getStats() {
     _commonStats.isEOF = isEOF();
     _specificStats.skip = _toSkip;
@@ -31,8 +31,8 @@
 #include <algorithm>
 #include <boost/algorithm/searching/boyer_moore.hpp>
 
-#include "mongo/db/fts/unicode/byte_vector.h"
 #include "mongo/platform/bits.h"
+#include "mongo/platform/byte_vector.h"
 #include "mongo/shell/linenoise_utf8.h"
 #include "mongo/util/assert_util.h"
 
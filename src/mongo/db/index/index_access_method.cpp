@@ -79,6 +79,27 @@ bool isMultikeyFromPaths(const MultikeyPaths& multikeyPaths) {
 
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
 
+// The number of threads each index build's external sort may use to sort and spill runs of keys.
+MONGO_EXPORT_SERVER_PARAMETER(internalIndexBuildExternalSortThreads, int, 1);
+
+// How index builds compress the runs of keys their external sorts spill to disk.
+std::string internalIndexBuildSpillCompressor = "snappy";
+
+class ExportedIndexBuildSpillCompressorParameter
+    : public ExportedServerParameter<std::string, ServerParameterType::kStartupOnly> {
+public:
+    ExportedIndexBuildSpillCompressorParameter()
+        : ExportedServerParameter<std::string, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(),
+              "internalIndexBuildSpillCompressor",
+              &internalIndexBuildSpillCompressor) {}
+
+    Status validate(const std::string& potentialNewValue) override {
+        return parseSorterFileCompressor(potentialNewValue).getStatus();
+    }
+
+} exportedIndexBuildSpillCompressorParameter;
+
 //
 // Comparison for external sorter interface
 //
@@ -447,7 +468,10 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .NumWorkerThreads(std::max(1, internalIndexBuildExternalSortThreads.load()))
+              .Compressor(uassertStatusOK(
+                  parseSorterFileCompressor(internalIndexBuildSpillCompressor))),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns true if 'expr' only looks at the elements along its path, so that it can be answered
+ * from the top-level field its path starts with.
+ */
+bool matchesWithinTopLevelField(const MatchExpression* expr) {
+    if (expr->path().empty()) {
+        return false;
+    }
+
+    switch (expr->matchType()) {
+        case MatchExpression::ELEM_MATCH_OBJECT:
+        case MatchExpression::ELEM_MATCH_VALUE:
+        case MatchExpression::SIZE:
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+        case MatchExpression::TYPE_OPERATOR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+StringData getTopLevelField(StringData path) {
+    return path.substr(0, path.find('.'));
+}
+
+}  // namespace
+
+/**
+ * Finds the top-level fields of a document for the slots of a compiled program. Each top-level
+ * field of the document is looked at no more than once.
+ */
+class CompiledMatchExpression::FieldCursor {
+public:
+    FieldCursor(const BSONObj& doc, const StringMap<size_t>& slotsByField)
+        : _it(doc), _slotsByField(slotsByField), _slots(slotsByField.size()) {}
+
+    /**
+     * Returns the first top-level field of the document that belongs in 'slot', or EOO if there
+     * is none.
+     */
+    BSONElement get(size_t slot) {
+        while (_slots[slot].eoo() && _it.more()) {
+            BSONElement elt = _it.next();
+            auto slotIt = _slotsByField.find(elt.fieldNameStringData());
+            if (_slotsByField.end() != slotIt && _slots[slotIt->second].eoo()) {
+                _slots[slotIt->second] = elt;
+            }
+        }
+        return _slots[slot];
+    }
+
+private:
+    BSONObjIterator _it;
+    const StringMap<size_t>& _slotsByField;
+    std::vector<BSONElement> _slots;
+};
+
+// static
+std::unique_ptr<CompiledMatchExpression> CompiledMatchExpression::compile(
+    const MatchExpression* expr) {
+    std::unique_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression());
+    compiled->_compile(expr);
+    if (compiled->_numSlotMatches < 2) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+void CompiledMatchExpression::_compile(const MatchExpression* expr) {
+    const size_t pc = _program.size();
+    _program.push_back({OpCode::kMatchDocument, expr, 0, 0});
+
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+            _program[pc].op = OpCode::kAnd;
+            break;
+        case MatchExpression::OR:
+            _program[pc].op = OpCode::kOr;
+            break;
+        case MatchExpression::NOR:
+            _program[pc].op = OpCode::kNor;
+            break;
+        case MatchExpression::NOT:
+            _program[pc].op = OpCode::kNot;
+            break;
+        default:
+            if (matchesWithinTopLevelField(expr)) {
+                StringData field = getTopLevelField(expr->path());
+                auto slotIt = _slotsByField.find(field);
+                if (_slotsByField.end() == slotIt) {
+                    const size_t slot = _slotsByField.size();
+                    _slotsByField[field] = slot;
+                    _program[pc].slot = slot;
+                } else {
+                    _program[pc].slot = slotIt->second;
+                }
+                _program[pc].op = OpCode::kMatchSlot;
+                ++_numSlotMatches;
+            }
+            _program[pc].end = pc + 1;
+            return;
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        _compile(expr->getChild(i));
+    }
+    _program[pc].end = _program.size();
+}
+
+bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) const {
+    FieldCursor cursor(doc, _slotsByField);
+    return _run(0, doc, &cursor);
+}
+
+bool CompiledMatchExpression::_run(size_t pc, const BSONObj& doc, FieldCursor* cursor) const {
+    const Instruction& instruction = _program[pc];
+    switch (instruction.op) {
+        case OpCode::kAnd:
+            for (size_t child = pc + 1; child < instruction.end; child = _program[child].end) {
+                if (!_run(child, doc, cursor)) {
+                    return false;
+                }
+            }
+            return true;
+        case OpCode::kOr:
+            for (size_t child = pc + 1; child < instruction.end; child = _program[child].end) {
+                if (_run(child, doc, cursor)) {
+                    return true;
+                }
+            }
+            return false;
+        case OpCode::kNor:
+            for (size_t child = pc + 1; child < instruction.end; child = _program[child].end) {
+                if (_run(child, doc, cursor)) {
+                    return false;
+                }
+            }
+            return true;
+        case OpCode::kNot:
+            return !_run(pc + 1, doc, cursor);
+        case OpCode::kMatchSlot:
+            return instruction.expr->matchesBSONElement(cursor->get(instruction.slot));
+        case OpCode::kMatchDocument:
+            return instruction.expr->matchesBSON(doc);
+    }
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace mongo
@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * A MatchExpression lowered into a flat program for matching whole BSON documents.
+ *
+ * Evaluating a MatchExpression tree looks up the top-level field of each predicate's path
+ * separately, so a filter with many predicates scans the same document many times. The compiled
+ * program gives each distinct top-level field a slot. While matching a document, it walks the
+ * document's top-level fields at most once, filling in slots as it goes and only going as far as
+ * the predicates it has evaluated so far need. Predicates then match against the element in
+ * their slot instead of the whole document. $and, $or, $nor and $not short-circuit as usual.
+ *
+ * Expressions that cannot be answered from a single top-level field, such as $where, match
+ * against the whole document as they normally would.
+ *
+ * The compiled program keeps pointers into the MatchExpression it was compiled from, which must
+ * outlive it and must not be modified.
+ */
+class CompiledMatchExpression {
+public:
+    /**
+     * Compiles 'expr'. Returns nullptr if the compiled program would not save any work compared
+     * to matching 'expr' directly, e.g. because it has fewer than two predicates that can use a
+     * slot.
+     */
+    static std::unique_ptr<CompiledMatchExpression> compile(const MatchExpression* expr);
+
+    /**
+     * Returns whether 'doc' matches the expression this program was compiled from.
+     */
+    bool matchesBSON(const BSONObj& doc) const;
+
+    /**
+     * Returns the number of distinct top-level fields used by the program's predicates.
+     */
+    size_t numSlots() const {
+        return _slotsByField.size();
+    }
+
+private:
+    enum class OpCode {
+        // Short-circuiting logical operators. Their operands are the instructions that follow,
+        // up to 'end'.
+        kAnd,
+        kOr,
+        kNor,
+        kNot,
+
+        // Matches 'expr' against the top-level field in 'slot'.
+        kMatchSlot,
+
+        // Matches 'expr' against the whole document.
+        kMatchDocument,
+    };
+
+    struct Instruction {
+        OpCode op;
+        const MatchExpression* expr;
+        size_t slot;
+
+        // One past the last instruction of the subprogram starting at this instruction.
+        size_t end;
+    };
+
+    class FieldCursor;
+
+    CompiledMatchExpression() = default;
+
+    void _compile(const MatchExpression* expr);
+
+    bool _run(size_t pc, const BSONObj& doc, FieldCursor* cursor) const;
+
+    std::vector<Instruction> _program;
+
+    // Maps each top-level field name used by a kMatchSlot instruction to its slot.
+    StringMap<size_t> _slotsByField;
+
+    size_t _numSlotMatches = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& query) {
+    const CollatorInterface* collator = nullptr;
+    StatusWithMatchExpression result =
+        MatchExpressionParser::parse(query, ExtensionsCallbackDisallowExtensions(), collator);
+    ASSERT_OK(result.getStatus());
+    return std::move(result.getValue());
+}
+
+/**
+ * Checks that the compiled form of 'query' agrees with the MatchExpression on every document in
+ * 'docs'.
+ */
+void assertMatchesLikeExpression(const BSONObj& query, const std::vector<BSONObj>& docs) {
+    auto expr = parse(query);
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    for (auto&& doc : docs) {
+        ASSERT_EQ(expr->matchesBSON(doc), compiled->matchesBSON(doc)) << query << " " << doc;
+    }
+}
+
+const std::vector<BSONObj> kDocs = {
+    fromjson("{}"),
+    fromjson("{a: 1, b: 2, c: 3}"),
+    fromjson("{c: 3, b: 2, a: 1}"),
+    fromjson("{a: 1, b: 5}"),
+    fromjson("{a: {b: 1, c: 'x'}, d: 4}"),
+    fromjson("{a: [{b: 1}, {b: 2, c: 'y'}], d: [1, 2, 3]}"),
+    fromjson("{a: [[1, 2], 3], b: null}"),
+    fromjson("{a: 2, a: 1, b: 2}"),
+    fromjson("{x: 1, y: 2, z: 3, a: {b: {c: 5}}, b: 'abc'}"),
+};
+
+TEST(CompiledMatchExpressionTest, NotCompiledWithFewerThanTwoSlotPredicates) {
+    ASSERT_FALSE(CompiledMatchExpression::compile(parse(fromjson("{a: 1}")).get()));
+    ASSERT_FALSE(CompiledMatchExpression::compile(parse(fromjson("{a: 1, $alwaysTrue: 1}")).get()));
+}
+
+TEST(CompiledMatchExpressionTest, PredicatesOnSameFieldShareSlot) {
+    auto expr = parse(fromjson("{a: {$gt: 0}, 'a.b': 1, 'a.c': 'x', d: 4}"));
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(2U, compiled->numSlots());
+}
+
+TEST(CompiledMatchExpressionTest, TopLevelPredicates) {
+    assertMatchesLikeExpression(fromjson("{a: 1, b: 2}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{a: 1, b: {$gte: 2}, c: {$exists: false}}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{b: null, a: {$type: 'array'}}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{a: {$in: [1, 2]}, b: {$regex: '^a'}}"), kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, DottedPredicates) {
+    assertMatchesLikeExpression(fromjson("{'a.b': 1, 'a.c': 'x'}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{'a.b': 2, 'a.c': 'y'}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{'a.0': [1, 2], 'a.1': 3}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{'a.b.c': 5, x: 1, b: {$size: 0}}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{'d.1': 2, a: {$elemMatch: {b: 2}}}"), kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, LogicalOperators) {
+    assertMatchesLikeExpression(fromjson("{$or: [{a: 1}, {'a.b': 1}], d: {$exists: true}}"),
+                                kDocs);
+    assertMatchesLikeExpression(fromjson("{$nor: [{a: 2}, {b: 5}]}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{a: {$not: {$gt: 1}}, b: {$ne: 5}}"), kDocs);
+    assertMatchesLikeExpression(
+        fromjson("{$and: [{$or: [{x: 1}, {c: 3}]}, {$or: [{y: 2}, {a: 1}]}]}"), kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, WholeDocumentExpressionsStillApply) {
+    assertMatchesLikeExpression(fromjson("{a: 1, b: 2, $alwaysFalse: 1}"), kDocs);
+    assertMatchesLikeExpression(fromjson("{$or: [{a: 1, b: 2}, {$alwaysTrue: 1}]}"), kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, UsesFirstOccurrenceOfDuplicateField) {
+    auto expr = parse(fromjson("{a: 2, b: 2}"));
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_TRUE(compiled->matchesBSON(fromjson("{a: 2, a: 1, b: 2}")));
+    ASSERT_FALSE(compiled->matchesBSON(fromjson("{a: 1, a: 2, b: 2}")));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -78,13 +78,28 @@ Status validateDepth(const BSONObj& obj) {
 }  // namespace
 
 StatusWith<BSONObj> fixDocumentForInsert(ServiceContext* service, const BSONObj& doc) {
+    BufBuilder buffer(doc.objsize() + 16);
+    auto offset = fixDocumentForInsert(service, doc, &buffer);
+    if (!offset.isOK())
+        return offset.getStatus();
+
+    if (offset.getValue() < 0)
+        return StatusWith<BSONObj>(BSONObj());
+
+    dassert(offset.getValue() == 0);
+    return StatusWith<BSONObj>(BSONObj(buffer.release()));
+}
+
+StatusWith<int> fixDocumentForInsert(ServiceContext* service,
+                                     const BSONObj& doc,
+                                     BufBuilder* buffer) {
     if (doc.objsize() > BSONObjMaxUserSize)
-        return StatusWith<BSONObj>(ErrorCodes::BadValue,
-                                   str::stream() << "object to insert too large"
-                                                 << ". size in bytes: "
-                                                 << doc.objsize()
-                                                 << ", max size: "
-                                                 << BSONObjMaxUserSize);
+        return StatusWith<int>(ErrorCodes::BadValue,
+                               str::stream() << "object to insert too large"
+                                             << ". size in bytes: "
+                                             << doc.objsize()
+                                             << ", max size: "
+                                             << BSONObjMaxUserSize);
 
     auto depthStatus = validateDepth(doc);
     if (!depthStatus.isOK()) {
@@ -108,7 +123,7 @@ StatusWith<BSONObj> fixDocumentForInsert(ServiceContext* service, const BSONObj&
             auto fieldName = e.fieldNameStringData();
 
             if (fieldName[0] == '$') {
-                return StatusWith<BSONObj>(
+                return StatusWith<int>(
                     ErrorCodes::BadValue,
                     str::stream() << "Document can't have $ prefixed field names: " << fieldName);
             }
@@ -118,24 +133,23 @@ StatusWith<BSONObj> fixDocumentForInsert(ServiceContext* service, const BSONObj&
             // Make sure _id isn't duplicated (SERVER-19361).
             if (fieldName == "_id") {
                 if (e.type() == RegEx) {
-                    return StatusWith<BSONObj>(ErrorCodes::BadValue, "can't use a regex for _id");
+                    return StatusWith<int>(ErrorCodes::BadValue, "can't use a regex for _id");
                 }
                 if (e.type() == Undefined) {
-                    return StatusWith<BSONObj>(ErrorCodes::BadValue,
-                                               "can't use a undefined for _id");
+                    return StatusWith<int>(ErrorCodes::BadValue, "can't use a undefined for _id");
                 }
                 if (e.type() == Array) {
-                    return StatusWith<BSONObj>(ErrorCodes::BadValue, "can't use an array for _id");
+                    return StatusWith<int>(ErrorCodes::BadValue, "can't use an array for _id");
                 }
                 if (e.type() == Object) {
                     BSONObj o = e.Obj();
                     Status s = o.storageValidEmbedded();
                     if (!s.isOK())
-                        return StatusWith<BSONObj>(s);
+                        return StatusWith<int>(s);
                 }
                 if (hadId) {
-                    return StatusWith<BSONObj>(ErrorCodes::BadValue,
-                                               "can't have multiple _id fields in one document");
+                    return StatusWith<int>(ErrorCodes::BadValue,
+                                           "can't have multiple _id fields in one document");
                 } else {
                     hadId = true;
                     firstElementIsId = isFirstElement;
@@ -145,11 +159,12 @@ StatusWith<BSONObj> fixDocumentForInsert(ServiceContext* service, const BSONObj&
     }
 
     if (firstElementIsId && !hasTimestampToFix)
-        return StatusWith<BSONObj>(BSONObj());
+        return StatusWith<int>(-1);
 
     BSONObjIterator i(doc);
 
-    BSONObjBuilder b(doc.objsize() + 16);
+    const int offset = buffer->len();
+    BSONObjBuilder b(*buffer);
     if (firstElementIsId) {
         b.append(doc.firstElement());
         i.next();
@@ -173,7 +188,8 @@ StatusWith<BSONObj> fixDocumentForInsert(ServiceContext* service, const BSONObj&
             b.append(e);
         }
     }
-    return StatusWith<BSONObj>(b.obj());
+    b.doneFast();
+    return StatusWith<int>(offset);
 }
 
 Status userAllowedWriteNS(StringData ns) {
@@ -45,6 +45,20 @@ class ServiceContext;
  */
 StatusWith<BSONObj> fixDocumentForInsert(ServiceContext* service, const BSONObj& doc);
 
+/**
+ * Same as above, but appends the document to insert instead of 'doc' to the end of 'buffer'
+ * rather than allocating a new buffer for it, so that the fixed documents of a whole batch can
+ * share a single allocation.
+ *
+ * This function returns:
+ *  - a non-OK status if 'doc' is not valid;
+ *  - -1 if 'doc' can be inserted as-is, in which case 'buffer' is left untouched; or
+ *  - the offset into 'buffer' of the document that should be inserted instead of 'doc'.
+ */
+StatusWith<int> fixDocumentForInsert(ServiceContext* service,
+                                     const BSONObj& doc,
+                                     BufBuilder* buffer);
+
 
 /**
  * Returns Status::OK() if this namespace is valid for user write operations.  If not, returns
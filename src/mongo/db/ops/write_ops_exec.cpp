@@ -454,29 +454,56 @@ WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& who
 
     auto session = OperationContextSession::get(opCtx);
 
+    // Documents are inserted straight out of the request, which shares ownership of the received
+    // message, unless they have to be fixed up first (typically to add an _id). Those are rebuilt
+    // into a buffer shared by the whole batch rather than being allocated one by one. Since the
+    // buffer may move while it grows, their batch entries are only pointed at it once the batch is
+    // complete.
+    boost::optional<BufBuilder> fixedDocsBuffer;
+    fixedDocsBuffer.emplace(0);
+    std::vector<std::pair<size_t, int>> fixedDocOffsets;  // Batch index and offset in the buffer.
+
     for (auto&& doc : wholeOp.getDocuments()) {
         const bool isLastDoc = (&doc == &wholeOp.getDocuments().back());
-        auto fixedDoc = fixDocumentForInsert(opCtx->getServiceContext(), doc);
+        auto fixedDoc = fixDocumentForInsert(opCtx->getServiceContext(), doc, &*fixedDocsBuffer);
         if (!fixedDoc.isOK()) {
             // Handled after we insert anything in the batch to be sure we report errors in the
             // correct order. In an ordered insert, if one of the docs ahead of us fails, we should
             // behave as-if we never got to this document.
         } else {
+            const int fixedDocOffset = fixedDoc.getValue();
             auto stmtId = getStmtIdForWriteOp(opCtx, wholeOp, stmtIdIndex++);
             if (session) {
                 if (auto entry = session->checkStatementExecuted(opCtx, stmtId)) {
+                    if (fixedDocOffset >= 0)
+                        fixedDocsBuffer->setlen(fixedDocOffset);
                     out.results.emplace_back(parseOplogEntryForInsert(*entry));
                     continue;
                 }
             }
 
-            BSONObj toInsert = fixedDoc.getValue().isEmpty() ? doc : std::move(fixedDoc.getValue());
-            batch.emplace_back(stmtId, toInsert);
-            bytesInBatch += batch.back().doc.objsize();
+            if (fixedDocOffset < 0) {
+                batch.emplace_back(stmtId, doc);
+                bytesInBatch += doc.objsize();
+            } else {
+                fixedDocOffsets.emplace_back(batch.size(), fixedDocOffset);
+                batch.emplace_back(stmtId, BSONObj());
+                bytesInBatch += fixedDocsBuffer->len() - fixedDocOffset;
+            }
             if (!isLastDoc && batch.size() < maxBatchSize && bytesInBatch < insertVectorMaxBytes)
                 continue;  // Add more to batch before inserting.
         }
 
+        if (!fixedDocOffsets.empty()) {
+            ConstSharedBuffer fixedDocs = fixedDocsBuffer->release();
+            for (auto&& fixedDocOffset : fixedDocOffsets) {
+                batch[fixedDocOffset.first].doc =
+                    BSONObj(fixedDocs.get() + fixedDocOffset.second).shareOwnershipWith(fixedDocs);
+            }
+            fixedDocOffsets.clear();
+            fixedDocsBuffer.emplace(0);
+        }
+
         bool canContinue = insertBatchAndHandleErrors(opCtx, wholeOp, batch, &lastOpFixer, &out);
         batch.clear();  // We won't need the current batch any more.
         bytesInBatch = 0;
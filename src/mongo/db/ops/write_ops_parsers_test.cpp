@@ -240,6 +240,36 @@ TEST(CommandWriteOpsParsers, RealMultiInsert) {
     }
 }
 
+TEST(CommandWriteOpsParsers, DocSequenceInsertDoesNotCopyDocuments) {
+    const auto ns = NamespaceString("test", "foo");
+    const BSONObj obj0 = BSON("x" << 0);
+    const BSONObj obj1 = BSON("x" << 1);
+
+    OpMsgBuilder builder;
+    {
+        auto docSeq = builder.beginDocSequence("documents");
+        docSeq.append(obj0);
+        docSeq.append(obj1);
+    }
+    builder.beginBody().append("insert", ns.coll()).append("$db", ns.db());
+    const auto message = builder.finish();
+
+    const auto request = OpMsgRequest::parse(message);
+    const auto op = InsertOp::parse(request);
+    ASSERT_EQ(op.getDocuments().size(), 2u);
+    ASSERT_BSONOBJ_EQ(op.getDocuments()[0], obj0);
+    ASSERT_BSONOBJ_EQ(op.getDocuments()[1], obj1);
+
+    // The parsed documents must be views into the received message, which they keep alive.
+    const char* const messageBegin = message.buf();
+    const char* const messageEnd = messageBegin + message.size();
+    for (auto&& doc : op.getDocuments()) {
+        ASSERT(doc.isOwned());
+        ASSERT(doc.objdata() >= messageBegin);
+        ASSERT(doc.objdata() + doc.objsize() <= messageEnd);
+    }
+}
+
 TEST(CommandWriteOpsParsers, Update) {
     const auto ns = NamespaceString("test", "foo");
     const BSONObj query = BSON("x" << 1);
@@ -28,6 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+#include <deque>
+
+#include "mongo/db/client.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -38,7 +42,13 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 
@@ -70,7 +80,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         accum->reset();  // Prep accumulators for a new group.
     }
 
-    if (_spilled) {
+    if (_mergedInParallel) {
+        return getNextParallel();
+    } else if (_spilledToPartitions) {
+        return getNextPartitioned();
+    } else if (_spilled) {
         return getNextSpilled();
     } else if (_streaming) {
         return getNextStreaming();
@@ -85,25 +99,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         return GetNextResult::makeEOF();
 
     _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
+        mergeAccumulatorStates(_firstPartOfNextGroup.second, _currentAccumulators);
 
         if (!_sorterIterator->more()) {
-            dispose();
+            if (_spilledToPartitions) {
+                // Only this partition is done. getNextPartitioned() will move on to the next one.
+                _sorterIterator.reset();
+            } else {
+                dispose();
+            }
             break;
         }
 
@@ -126,6 +133,50 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextPartitioned() {
+    while (true) {
+        if (_sorterIterator) {
+            // The current partition did not fit in memory, so it is being merged from sorted runs.
+            return getNextSpilled();
+        }
+
+        if (groupsIterator != _groups->end()) {
+            Document out =
+                makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+            ++groupsIterator;
+            return std::move(out);
+        }
+
+        // Skip over partitions which never had any groups spilled to them.
+        while (_nextPartition < _partitionFiles.size() && !_partitionFiles[_nextPartition]) {
+            ++_nextPartition;
+        }
+
+        if (_nextPartition == _partitionFiles.size()) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+
+        loadSpilledPartition(_nextPartition++);
+    }
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::getNextParallel() {
+    while (groupsIterator == _groups->end()) {
+        if (_nextPartition == _parallelGroups.size()) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+
+        _groups = std::move(_parallelGroups[_nextPartition++]);
+        groupsIterator = _groups->begin();
+    }
+
+    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    ++groupsIterator;
+    return std::move(out);
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
     // Streaming optimization is active.
     if (!_firstDocOfNextGroup) {
@@ -168,6 +219,10 @@ void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _partitionWriters.clear();
+    _partitionFiles.clear();
+    _parallelMerge.reset();
+    _parallelGroups.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -266,8 +321,12 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
+      _numSpillPartitions(std::max(0, internalDocumentSourceGroupSpillPartitions.load())),
+      _numMergeThreads(std::max(0, internalDocumentSourceGroupMergeThreads.load())),
       _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter) {}
 
+DocumentSourceGroup::~DocumentSourceGroup() = default;
+
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
     _accumulatedFields.push_back(accumulationStatement);
 }
@@ -478,6 +537,10 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     }
 
 
+    if (canMergeInParallel()) {
+        return initializeParallel();
+    }
+
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
@@ -486,7 +549,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _extSortAllowed);
-            _sortedFiles.push_back(spill());
+            if (_numSpillPartitions > 0) {
+                spillToPartitions();
+            } else {
+                _sortedFiles.push_back(spill());
+            }
             _memoryUsageBytes = 0;
         }
 
@@ -548,7 +615,31 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (!_partitionWriters.empty()) {
+                _spilled = true;
+                _spilledToPartitions = true;
+                if (!_groups->empty()) {
+                    spillToPartitions();
+                }
+
+                // Close each partition's file so that it can be read back.
+                _partitionFiles.resize(_partitionWriters.size());
+                for (size_t i = 0; i < _partitionWriters.size(); i++) {
+                    if (_partitionWriters[i]) {
+                        _partitionFiles[i].reset(_partitionWriters[i]->done());
+                    }
+                }
+                _partitionWriters.clear();
+
+                // This is used to merge any partition which turns out to be too large for memory.
+                _currentAccumulators.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                }
+
+                // getNextPartitioned() will load the first partition.
+                groupsIterator = _groups->end();
+            } else if (!_sortedFiles.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
                     _sortedFiles.push_back(spill());
@@ -582,6 +673,306 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+namespace {
+
+ThreadPool* getMergeWorkerPool() {
+    static ThreadPool* const pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "GroupMerge";
+        options.minThreads = 0;
+        options.maxThreads = DocumentSourceGroup::kMaxMergePoolThreads;
+        options.onCreateThread = [](const std::string& threadName) {
+            // Unit tests of the pipeline run without a global service context.
+            if (hasGlobalServiceContext()) {
+                Client::initThread(threadName.c_str());
+            }
+        };
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return pool;
+}
+
+}  // namespace
+
+/**
+ * Accumulates partial groups on the worker pool shared by all merging $groups. Each group key is
+ * owned by the worker its hash maps to, so workers never share a hash table, and the thread
+ * reading the input only computes group keys and hands documents off in batches.
+ *
+ * A worker is not a thread: whenever it has batches queued, a task draining its queue is scheduled
+ * on the pool. The task gives up its thread after a few batches, so that a long merge does not
+ * keep other merges from running, and never blocks, so that merges cannot deadlock waiting for
+ * each other's threads.
+ */
+class DocumentSourceGroup::ParallelMerge {
+    MONGO_DISALLOW_COPYING(ParallelMerge);
+
+public:
+    ParallelMerge(DocumentSourceGroup* group, size_t numWorkers) : _group(group) {
+        _workers.reserve(numWorkers);
+        for (size_t i = 0; i < numWorkers; ++i) {
+            _workers.push_back(stdx::make_unique<Worker>(
+                group->pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()));
+        }
+    }
+
+    ~ParallelMerge() {
+        // The queued input is no longer needed, but the tasks still refer to the workers.
+        _failed.store(true);
+        _waitForWorkers();
+    }
+
+    /**
+     * Queues 'root', whose group key is 'id', to be accumulated by the worker owning 'id'. Throws
+     * if a worker has failed or the groups have outgrown the memory limit of the $group.
+     */
+    void add(Value id, Document root) {
+        const uint64_t hash = _group->pExpCtx->getValueComparator().hash(id);
+
+        // The workers' hash tables use the same hash, so pick the worker using its high bits to
+        // avoid leaving each table with keys which all fall into the same residue class.
+        Worker* worker = _workers[((hash * 0x9E3779B97F4A7C15ULL) >> 32) % _workers.size()].get();
+        worker->pending.emplace_back(std::move(id), std::move(root));
+        if (worker->pending.size() == kBatchSize) {
+            _handOff(worker);
+        }
+    }
+
+    /**
+     * Waits for all of the queued input to be accumulated and returns each worker's groups.
+     */
+    std::vector<GroupsMap> finish() {
+        for (auto&& worker : _workers) {
+            if (!worker->pending.empty()) {
+                _handOff(worker.get());
+            }
+        }
+        _waitForWorkers();
+        _checkStatus();
+
+        std::vector<GroupsMap> groups;
+        groups.reserve(_workers.size());
+        for (auto&& worker : _workers) {
+            groups.push_back(std::move(worker->groups));
+        }
+        return groups;
+    }
+
+private:
+    using Batch = std::vector<std::pair<Value, Document>>;
+
+    // The number of documents handed off to a worker at a time, and the number of batches which
+    // may be waiting for a worker before the thread reading the input blocks. A task draining a
+    // worker's queue reschedules itself after accumulating kMaxQueuedBatches batches.
+    static constexpr size_t kBatchSize = 128;
+    static constexpr size_t kMaxQueuedBatches = 8;
+
+    struct Worker {
+        explicit Worker(GroupsMap groups) : groups(std::move(groups)) {}
+
+        // Guards 'queue' and 'scheduled'. 'queueChanged' is signaled when either changes.
+        stdx::mutex mutex;
+        stdx::condition_variable queueChanged;
+        std::deque<Batch> queue;
+
+        // Whether a task draining 'queue' is scheduled or running.
+        bool scheduled = false;
+
+        // Only accessed by the thread reading the input.
+        Batch pending;
+
+        // Only accessed by the task draining 'queue', and once the workers are idle.
+        GroupsMap groups;
+    };
+
+    void _handOff(Worker* worker) {
+        _checkStatus();
+
+        Batch batch;
+        batch.reserve(kBatchSize);
+        std::swap(batch, worker->pending);
+
+        stdx::unique_lock<stdx::mutex> lk(worker->mutex);
+        worker->queueChanged.wait(lk, [&] { return worker->queue.size() < kMaxQueuedBatches; });
+        worker->queue.push_back(std::move(batch));
+        worker->queueChanged.notify_all();
+        if (!worker->scheduled) {
+            worker->scheduled = true;
+            _schedule_inlock(worker);
+        }
+    }
+
+    void _schedule_inlock(Worker* worker) {
+        Status status = getMergeWorkerPool()->schedule([this, worker] { _drain(worker); });
+        if (!status.isOK()) {
+            worker->scheduled = false;
+            worker->queue.clear();
+            worker->queueChanged.notify_all();
+            _fail(status);
+        }
+    }
+
+    void _drain(Worker* worker) {
+        for (size_t numBatches = 0;; ++numBatches) {
+            Batch batch;
+            {
+                stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+                if (worker->queue.empty()) {
+                    worker->scheduled = false;
+                    worker->queueChanged.notify_all();
+                    return;
+                }
+                if (numBatches == kMaxQueuedBatches) {
+                    // Let the tasks of other merges run before accumulating any more.
+                    _schedule_inlock(worker);
+                    return;
+                }
+                batch = std::move(worker->queue.front());
+                worker->queue.pop_front();
+                worker->queueChanged.notify_all();
+            }
+
+            // After a failure, keep draining the queue so that the input thread never blocks on a
+            // worker which has stopped accumulating.
+            if (_failed.load()) {
+                continue;
+            }
+
+            try {
+                _accumulate(worker, &batch);
+            } catch (const DBException& ex) {
+                _fail(ex.toStatus());
+            }
+        }
+    }
+
+    void _accumulate(Worker* worker, Batch* batch) {
+        const auto& accumulatedFields = _group->_accumulatedFields;
+        const size_t numAccumulators = accumulatedFields.size();
+
+        long long memoryUsageDelta = 0;
+        for (auto&& input : *batch) {
+            const size_t oldSize = worker->groups.size();
+            Accumulators& group = worker->groups[input.first];
+            const bool inserted = worker->groups.size() != oldSize;
+
+            if (inserted) {
+                memoryUsageDelta += input.first.getApproximateSize();
+
+                group.reserve(numAccumulators);
+                for (auto&& accumulatedField : accumulatedFields) {
+                    group.push_back(accumulatedField.makeAccumulator(_group->pExpCtx));
+                }
+            } else {
+                for (auto&& groupObj : group) {
+                    memoryUsageDelta -= groupObj->memUsageForSorter();
+                }
+            }
+
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i]->process(accumulatedFields[i].expression->evaluate(input.second),
+                                  _group->_doingMerge);
+                memoryUsageDelta += group[i]->memUsageForSorter();
+            }
+        }
+
+        _memoryUsageBytes.fetchAndAdd(memoryUsageDelta);
+    }
+
+    void _fail(Status status) {
+        stdx::lock_guard<stdx::mutex> lk(_statusMutex);
+        if (_status.isOK()) {
+            _status = std::move(status);
+        }
+        _failed.store(true);
+    }
+
+    void _checkStatus() {
+        if (_failed.load()) {
+            stdx::lock_guard<stdx::mutex> lk(_statusMutex);
+            uassertStatusOK(_status);
+        }
+
+        uassert(40596,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _memoryUsageBytes.load() <= static_cast<long long>(_group->_maxMemoryUsageBytes));
+    }
+
+    /**
+     * Waits until no worker has a task scheduled or running, i.e. all of the queued input has
+     * been drained.
+     */
+    void _waitForWorkers() {
+        for (auto&& worker : _workers) {
+            stdx::unique_lock<stdx::mutex> lk(worker->mutex);
+            worker->queueChanged.wait(lk, [&] { return !worker->scheduled; });
+        }
+    }
+
+    DocumentSourceGroup* const _group;
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // The approximate memory used by the groups of all workers.
+    AtomicWord<long long> _memoryUsageBytes{0};
+
+    // Set when accumulating fails on a worker, along with '_status' unless the merge is being
+    // abandoned.
+    AtomicBool _failed{false};
+    stdx::mutex _statusMutex;
+    Status _status = Status::OK();
+};
+
+constexpr size_t DocumentSourceGroup::ParallelMerge::kBatchSize;
+constexpr size_t DocumentSourceGroup::ParallelMerge::kMaxQueuedBatches;
+
+bool DocumentSourceGroup::canMergeInParallel() const {
+    // The thread reading the input is the one which would spill, so only a $group which cannot
+    // spill is merged on worker threads.
+    if (!_doingMerge || _extSortAllowed || _numMergeThreads < 2) {
+        return false;
+    }
+
+    // The workers evaluate the accumulator arguments concurrently, which is only safe for
+    // expressions that do not bind variables. When merging, these are always field paths.
+    return std::all_of(
+        _accumulatedFields.begin(), _accumulatedFields.end(), [](const auto& accumulatedField) {
+            auto expression = accumulatedField.expression.get();
+            return dynamic_cast<ExpressionFieldPath*>(expression) ||
+                dynamic_cast<ExpressionConstant*>(expression);
+        });
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::initializeParallel() {
+    if (!_parallelMerge) {
+        _parallelMerge = stdx::make_unique<ParallelMerge>(this, _numMergeThreads);
+    }
+
+    // Barring any pausing, this loop exhausts 'pSource'. The workers accumulate the groups.
+    GetNextResult input = pSource->getNext();
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        auto rootDocument = input.releaseDocument();
+        Value id = computeId(rootDocument);
+        _parallelMerge->add(std::move(id), std::move(rootDocument));
+    }
+
+    if (input.isPaused()) {
+        return input;
+    }
+    invariant(input.isEOF());
+
+    _parallelGroups = _parallelMerge->finish();
+    _parallelMerge.reset();
+
+    // getNextParallel() will move on to the first worker's groups.
+    _mergedInParallel = true;
+    groupsIterator = _groups->end();
+    _initialized = true;
+    return input;
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
@@ -592,34 +983,130 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        writer.addAlreadySorted(ptrs[i]->first, serializeAccumulatorStates(ptrs[i]->second));
+    }
+
+    _groups->clear();
+
+    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+}
+
+void DocumentSourceGroup::spillToPartitions() {
+    invariant(_numSpillPartitions > 0);
+    _partitionWriters.resize(_numSpillPartitions);
+
+    const ValueComparator& valueComparator = pExpCtx->getValueComparator();
+    for (auto&& group : *_groups) {
+        // Mix the hash so that the partition is independent of the bucket the group occupies in
+        // the hash table it will be merged into.
+        const uint64_t hash = valueComparator.hash(group.first) * 0x9E3779B97F4A7C15ULL;
+        auto& writer = _partitionWriters[(hash >> 32) % _numSpillPartitions];
+        if (!writer) {
+            writer = stdx::make_unique<SortedFileWriter<Value, Value>>(
+                SortOptions().TempDir(pExpCtx->tempDir));
+        }
+
+        // The groups within a partition do not need to be in any particular order.
+        writer->addAlreadySorted(group.first, serializeAccumulatorStates(group.second));
+    }
+
+    _groups->clear();
+}
+
+void DocumentSourceGroup::loadSpilledPartition(size_t partition) {
+    // Take ownership of the partition so that its file is removed once it has been read.
+    auto partitionFile = std::move(_partitionFiles[partition]);
+    invariant(partitionFile);
+
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _memoryUsageBytes = 0;
+    invariant(_sortedFiles.empty());
+
+    while (partitionFile->more()) {
+        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+            // This partition is too large to merge in memory, so fall back to merging sorted runs
+            // of its partially accumulated groups.
+            _sortedFiles.push_back(spill());
+            _memoryUsageBytes = 0;
+        }
+
+        auto spilledGroup = partitionFile->next();
+
+        const size_t oldSize = _groups->size();
+        Accumulators& group = (*_groups)[spilledGroup.first];
+        const bool inserted = _groups->size() != oldSize;
+
+        if (inserted) {
+            _memoryUsageBytes += spilledGroup.first.getApproximateSize();
+
+            group.reserve(_accumulatedFields.size());
+            for (auto&& accumulatedField : _accumulatedFields) {
+                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
             }
-            break;
+        } else {
+            for (auto&& groupObj : group) {
+                _memoryUsageBytes -= groupObj->memUsageForSorter();
+            }
+        }
+
+        mergeAccumulatorStates(spilledGroup.second, group);
+
+        for (auto&& groupObj : group) {
+            _memoryUsageBytes += groupObj->memUsageForSorter();
+        }
+    }
+
+    if (!_sortedFiles.empty()) {
+        if (!_groups->empty()) {
+            _sortedFiles.push_back(spill());
+        }
+
+        _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+            _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+        _sortedFiles.clear();
+
+        verify(_sorterIterator->more());
+        _firstPartOfNextGroup = _sorterIterator->next();
+    }
+
+    groupsIterator = _groups->begin();
+}
+
+Value DocumentSourceGroup::serializeAccumulatorStates(const Accumulators& accums) const {
+    switch (accums.size()) {  // same as _accumulatedFields.size()
+        case 0:               // no values, essentially a distinct
+            return Value();
 
         case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
-            }
-            break;
+            return accums[0]->getValue(/*toBeMerged=*/true);
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
-                }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accums.size());
+            for (auto&& accum : accums) {
+                states.push_back(accum->getValue(/*toBeMerged=*/true));
             }
-            break;
+            return Value(std::move(states));
+        }
     }
+}
 
-    _groups->clear();
-
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+void DocumentSourceGroup::mergeAccumulatorStates(const Value& states,
+                                                 const Accumulators& accums) const {
+    const size_t numAccumulators = accums.size();
+    switch (numAccumulators) {  // mirrors switch in serializeAccumulatorStates()
+        case 1:                 // Single accumulators serialize as a single Value.
+            accums[0]->process(states, true);
+        case 0:  // No accumulators so no Values.
+            break;
+        default: {  // Multiple accumulators serialize as an array of Values.
+            const vector<Value>& accumulatorStates = states.getArray();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                accums[i]->process(accumulatorStates[i], true);
+            }
+        }
+    }
 }
 
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
@@ -695,7 +1182,8 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // Groups spilled to hash partitions are returned in no particular order.
+    if (!(_streaming || _spilled) || _spilledToPartitions) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
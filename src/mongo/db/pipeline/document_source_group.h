@@ -45,6 +45,11 @@ public:
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    // The most threads the worker pool shared by all merging $groups runs at once.
+    static const size_t kMaxMergePoolThreads = 64;
+
+    ~DocumentSourceGroup();
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -98,6 +103,8 @@ protected:
     void doDispose() final;
 
 private:
+    class ParallelMerge;
+
     explicit DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext>& pExpCtx,
                                  size_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes);
 
@@ -110,6 +117,20 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Returns results after the groups have been spilled into hash partitions. Each partition is
+     * read back and merged in its own hash table, and results are returned one partition at a
+     * time. A partition too large to fit in memory is merged using sorted runs instead.
+     */
+    GetNextResult getNextPartitioned();
+
+    /**
+     * Returns results after the input has been merged on worker threads. Each worker accumulated
+     * a disjoint set of groups in its own hash table, and results are returned one table at a
+     * time.
+     */
+    GetNextResult getNextParallel();
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -128,6 +149,18 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Used by initialize() in place of accumulating the input itself when canMergeInParallel() is
+     * true. Consumes the input, handing each document off to the worker which owns its group.
+     */
+    GetNextResult initializeParallel();
+
+    /**
+     * Returns true if this $group merges partial groups from the shards, cannot spill to disk, and
+     * has enough merge threads configured to accumulate its input on worker threads.
+     */
+    bool canMergeInParallel() const;
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -135,6 +168,31 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Spills the partially accumulated contents of the groups map into per-partition files chosen
+     * by hashing the group key. Unlike spill(), this does not need to sort the groups, since each
+     * partition is merged back in a hash table by loadSpilledPartition().
+     */
+    void spillToPartitions();
+
+    /**
+     * Reads back the spilled partition numbered 'partition' and merges its accumulator states into
+     * '_groups'. If the partition does not fit in memory, it is instead spilled as sorted runs and
+     * '_sorterIterator' is prepared to merge them.
+     */
+    void loadSpilledPartition(size_t partition);
+
+    /**
+     * Returns the serialized, mergeable form of the state of 'accums', as written to spill files.
+     */
+    Value serializeAccumulatorStates(const Accumulators& accums) const;
+
+    /**
+     * Merges the serialized accumulator states 'states' produced by serializeAccumulatorStates()
+     * into 'accums'.
+     */
+    void mergeAccumulatorStates(const Value& states, const Accumulators& accums) const;
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
@@ -171,6 +229,28 @@ private:
     std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     bool _spilled;
 
+    // The number of hash partitions to spill to, or 0 if spilling should always sort the groups.
+    const size_t _numSpillPartitions;
+
+    // Only used when spilling to partitions. The writers are open while the input is being
+    // consumed, and each is replaced by an iterator over its file once the input is exhausted.
+    // Partitions which never had any groups spilled to them have neither.
+    std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>> _partitionWriters;
+    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _partitionFiles;
+    size_t _nextPartition = 0;
+    bool _spilledToPartitions = false;
+
+    // The number of workers to merge on, or 0 if merging always happens on this thread. The
+    // workers' tasks run on a pool shared by all merging $groups.
+    const size_t _numMergeThreads;
+
+    // Only used when merging in parallel. '_parallelMerge' owns the workers while the input is
+    // being consumed, after which their groups are moved to '_parallelGroups' and returned from
+    // there in turn, using '_nextPartition' to track the next one.
+    std::unique_ptr<ParallelMerge> _parallelMerge;
+    std::vector<GroupsMap> _parallelGroups;
+    bool _mergedInParallel = false;
+
     // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
 
@@ -47,12 +47,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -139,6 +141,98 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldMergePartialGroupsSpilledToPartitions) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->extSortAllowed = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionConstant::create(expCtx, Value(1)),
+                                         AccumulationStatement::getFactory("$sum")};
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {countStatement, pushStatement}, maxMemoryUsageBytes);
+
+    // Each key is seen several times, with a spill between each occurrence, so every key ends up
+    // with several partially accumulated groups spread across the spill files.
+    string largeStr(maxMemoryUsageBytes, 'x');
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int round = 0; round < 3; ++round) {
+        for (int key = 0; key < 10; ++key) {
+            inputs.emplace_back(Document{{"key", key}, {"largeStr", largeStr}});
+        }
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    // Hash partitioned output comes back in no particular order.
+    map<int, int> counts;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(doc["spaceHog"].getArrayLength(), 3UL);
+        counts[doc["_id"].coerceToInt()] += doc["count"].coerceToInt();
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->getOutputSorts().empty());
+
+    ASSERT_EQ(counts.size(), 10UL);
+    for (auto&& count : counts) {
+        ASSERT_EQ(count.second, 3);
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldMergeSpilledPartitionWhichDoesNotFitInMemory) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->extSortAllowed = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    // With a single partition, every group is read back into the same hash table, which must then
+    // fall back to merging sorted runs.
+    const int originalSpillPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    internalDocumentSourceGroupSpillPartitions.store(1);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGroupSpillPartitions.store(originalSpillPartitions); });
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    string largeStr(maxMemoryUsageBytes, 'x');
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int round = 0; round < 2; ++round) {
+        for (int key = 0; key < 5; ++key) {
+            inputs.emplace_back(Document{{"key", key}, {"largeStr", largeStr}});
+        }
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    stdx::unordered_set<int> idSet;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(doc["spaceHog"].getArrayLength(), 2UL);
+        ASSERT_TRUE(idSet.insert(doc["_id"].coerceToInt()).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_EQ(idSet.size(), 5UL);
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -189,6 +283,75 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), UserException, 16945);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldMergePartialGroupsOnWorkerThreads) {
+    auto expCtx = getExpCtx();
+    expCtx->inRouter = true;  // Disallow external sort.
+
+    const int originalMergeThreads = internalDocumentSourceGroupMergeThreads.load();
+    internalDocumentSourceGroupMergeThreads.store(4);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupMergeThreads.store(originalMergeThreads); });
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionFieldPath::parse(expCtx, "$count", vps),
+                                         AccumulationStatement::getFactory("$sum")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(expCtx, groupByExpression, {countStatement});
+    group->setDoingMerge(true);
+
+    // Each key arrives as a partial group from each of three shards, with a pause in between, and
+    // in numbers large enough for every worker to be handed several batches.
+    const int numKeys = 1000;
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int shard = 0; shard < 3; ++shard) {
+        for (int key = 0; key < numKeys; ++key) {
+            inputs.emplace_back(Document{{"_id", key}, {"count", shard + 1}});
+        }
+        inputs.emplace_back(DocumentSource::GetNextResult::makePauseExecution());
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    ASSERT_TRUE(group->getNext().isPaused());
+    ASSERT_TRUE(group->getNext().isPaused());
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    stdx::unordered_set<int> idSet;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(doc["count"].coerceToInt(), 6);
+        ASSERT_TRUE(idSet.insert(doc["_id"].coerceToInt()).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_EQ(idSet.size(), static_cast<size_t>(numKeys));
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldErrorIfParallelMergeResultSetIsTooLarge) {
+    auto expCtx = getExpCtx();
+    const size_t maxMemoryUsageBytes = 1000;
+    expCtx->inRouter = true;  // Disallow external sort.
+
+    const int originalMergeThreads = internalDocumentSourceGroupMergeThreads.load();
+    internalDocumentSourceGroupMergeThreads.store(2);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupMergeThreads.store(originalMergeThreads); });
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$spaceHog", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+    group->setDoingMerge(true);
+
+    Value largeArray(vector<Value>{Value(string(maxMemoryUsageBytes, 'x'))});
+    auto mock = DocumentSourceMock::create({Document{{"_id", 0}, {"spaceHog", largeArray}},
+                                            Document{{"_id", 1}, {"spaceHog", largeArray}}});
+    group->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(group->getNext(), UserException, 40596);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
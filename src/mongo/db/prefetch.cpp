@@ -44,6 +44,7 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/util/log.h"
@@ -148,6 +149,13 @@ void prefetchRecordPages(OperationContext* opCtx,
 }
 }  // namespace
 
+LockMode prefetchCollectionLockMode(bool supportsDocLocking) {
+    // Engines with document-level locking page in data through the same cursors used for normal
+    // reads, so IS is enough and doesn't block the writer threads. MMAP V1 acquires S lock on the
+    // collection, instead of optimizing with IS.
+    return supportsDocLocking ? MODE_IS : MODE_S;
+}
+
 // prefetch for an oplog operation
 void prefetchPagesForReplicatedOp(OperationContext* opCtx, Database* db, const BSONObj& op) {
     invariant(db);
@@ -171,10 +179,11 @@ void prefetchPagesForReplicatedOp(OperationContext* opCtx, Database* db, const B
     BSONObj obj = op.getObjectField(opField);
     const char* ns = op.getStringField("ns");
 
-    // This will have to change for engines other than MMAP V1, because they might not have
-    // means for directly prefetching pages from the collection. For this purpose, acquire S
-    // lock on the database, instead of optimizing with IS.
-    Lock::CollectionLock collLock(opCtx->lockState(), ns, MODE_S);
+    Lock::CollectionLock collLock(
+        opCtx->lockState(),
+        ns,
+        prefetchCollectionLockMode(
+            opCtx->getServiceContext()->getGlobalStorageEngine()->supportsDocLocking()));
 
     Collection* collection = db->getCollection(opCtx, ns);
     if (!collection) {
@@ -27,6 +27,8 @@
 */
 #pragma once
 
+#include "mongo/db/concurrency/lock_manager_defs.h"
+
 namespace mongo {
 class BSONObj;
 class Database;
@@ -35,5 +37,8 @@ namespace repl {
 
 // page in possible index and/or data pages for an op from the oplog
 void prefetchPagesForReplicatedOp(OperationContext* opCtx, Database* db, const BSONObj& op);
+
+// the mode in which prefetchPagesForReplicatedOp() locks the op's collection
+LockMode prefetchCollectionLockMode(bool supportsDocLocking);
 }  // namespace repl
 }  // namespace mongo
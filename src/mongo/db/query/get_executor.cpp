@@ -230,6 +230,38 @@ struct PrepareExecutionResult {
     unique_ptr<PlanStage> root;
 };
 
+bool solutionHasLimit(const QuerySolutionNode* node) {
+    if (STAGE_LIMIT == node->getType()) {
+        return true;
+    }
+    for (const QuerySolutionNode* child : node->children) {
+        if (solutionHasLimit(child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Scans may only filter ahead of their consumer when the whole plan will be run: filtering
+ * records which a limit would never have asked for wastes work, and a multi-plan trial only runs
+ * each candidate for a few works.
+ */
+bool canFilterInParallel(const CanonicalQuery& canonicalQuery,
+                         const QuerySolution& solution,
+                         size_t plannerOptions) {
+    if (!(plannerOptions & QueryPlannerParams::ALLOW_PARALLEL_FILTER)) {
+        return false;
+    }
+
+    const QueryRequest& qr = canonicalQuery.getQueryRequest();
+    if (qr.getLimit() || qr.getNToReturn() || !qr.wantMore()) {
+        return false;
+    }
+
+    return !solutionHasLimit(solution.root.get());
+}
+
 /**
  * Build an execution tree for the query described in 'canonicalQuery'.
  *
@@ -425,6 +457,9 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
 
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
+        solutions[0]->allowParallelFilter =
+            canFilterInParallel(*canonicalQuery, *solutions[0], plannerOptions);
+
         PlanStage* rawRoot;
         verify(
             StageBuilder::build(opCtx, collection, *canonicalQuery, *solutions[0], ws, &rawRoot));
@@ -630,7 +665,8 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorFind(
         return getOplogStartHack(opCtx, collection, std::move(canonicalQuery));
     }
 
-    size_t options = QueryPlannerParams::DEFAULT;
+    // A find without a limit reads every result, one batch after another.
+    size_t options = QueryPlannerParams::ALLOW_PARALLEL_FILTER;
     if (ShardingState::get(opCtx)->needCollectionMetadata(opCtx, nss.ns())) {
         options |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
@@ -1268,7 +1304,12 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorCount(
             opCtx, std::move(ws), std::move(root), request.getNs(), yieldPolicy);
     }
 
-    const size_t plannerOptions = QueryPlannerParams::IS_COUNT;
+    size_t plannerOptions = QueryPlannerParams::IS_COUNT;
+    if (request.getLimit() == 0) {
+        // The count stage applies its own limit, which the plan below can't see.
+        plannerOptions |= QueryPlannerParams::ALLOW_PARALLEL_FILTER;
+    }
+
     StatusWith<PrepareExecutionResult> executionResult =
         prepareExecution(opCtx, collection, ws.get(), std::move(cq), plannerOptions);
     if (!executionResult.isOK()) {
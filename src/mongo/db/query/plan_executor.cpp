@@ -45,6 +45,7 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
@@ -373,7 +374,7 @@ void PlanExecutor::invalidate(OperationContext* opCtx, const RecordId& dl, Inval
 
 PlanExecutor::ExecState PlanExecutor::getNext(BSONObj* objOut, RecordId* dlOut) {
     Snapshotted<BSONObj> snapshotted;
-    ExecState state = getNextImpl(objOut ? &snapshotted : NULL, dlOut);
+    ExecState state = getNextImpl(objOut ? &snapshotted : NULL, dlOut, true);
 
     if (objOut) {
         *objOut = snapshotted.value();
@@ -386,7 +387,7 @@ PlanExecutor::ExecState PlanExecutor::getNextSnapshotted(Snapshotted<BSONObj>* o
                                                          RecordId* dlOut) {
     // Detaching from the OperationContext means that the returned snapshot ids could be invalid.
     invariant(!_everDetachedFromOperationContext);
-    return getNextImpl(objOut, dlOut);
+    return getNextImpl(objOut, dlOut, false);
 }
 
 
@@ -433,7 +434,19 @@ bool PlanExecutor::waitForInserts() {
     return yieldResult;
 }
 
-PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut) {
+size_t PlanExecutor::_getWorkBatchSize(Snapshotted<BSONObj>* objOut, RecordId* dlOut) const {
+    // Batched results are stashed as owned documents, so only callers which want nothing else can
+    // use them. Write stages must only do as much work as their caller consumes.
+    if (!objOut || dlOut || STAGE_UPDATE == _root->stageType() ||
+        STAGE_DELETE == _root->stageType()) {
+        return 1;
+    }
+    return static_cast<size_t>(std::max(1, internalQueryExecBatchSize.load()));
+}
+
+PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
+                                                  RecordId* dlOut,
+                                                  bool allowBatching) {
     if (MONGO_FAIL_POINT(planExecutorAlwaysFails)) {
         Status status(ErrorCodes::OperationFailed,
                       str::stream() << "PlanExecutor hit planExecutorAlwaysFails fail point");
@@ -470,6 +483,8 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
     // Incremented on every writeConflict, reset to 0 on any successful call to _root->work.
     size_t writeConflictsInARow = 0;
 
+    const size_t workBatchSize = allowBatching ? _getWorkBatchSize(objOut, dlOut) : 1;
+
     for (;;) {
         // These are the conditions which can cause us to yield:
         //   1) The yield policy's timer elapsed, or
@@ -497,12 +512,34 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         fetcher.reset();
 
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code = workBatchSize > 1
+            ? _root->workBatch(workBatchSize, _workingSet.get(), &_workBatch, &id)
+            : _root->work(&id);
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
 
-        if (PlanStage::ADVANCED == code) {
+        if (PlanStage::ADVANCED == code && workBatchSize > 1) {
+            for (auto&& batchId : _workBatch) {
+                WorkingSetMember* member = _workingSet->get(batchId);
+                if (WorkingSetMember::RID_AND_IDX == member->getState()) {
+                    if (1 == member->keyData.size()) {
+                        _stash.push(member->keyData[0].keyData.getOwned());
+                    }
+                } else if (member->hasObj()) {
+                    _stash.push(member->obj.value().getOwned());
+                }
+                _workingSet->free(batchId);
+            }
+            _workBatch.clear();
+
+            if (!_stash.empty()) {
+                *objOut = {SnapshotId(), _stash.front()};
+                _stash.pop();
+                return PlanExecutor::ADVANCED;
+            }
+            // None of these results had the data the caller wanted, try again.
+        } else if (PlanStage::ADVANCED == code) {
             WorkingSetMember* member = _workingSet->get(id);
             bool hasRequestedData = true;
 
@@ -30,9 +30,11 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/util/partitioned.h"
+#include "mongo/db/exec/working_set.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -452,7 +454,13 @@ private:
     // returns true immediately.
     bool waitForInserts();
 
-    ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
+    // If 'allowBatching' is true, results may be produced several at a time and stashed until
+    // they are returned, without a snapshot id. See internalQueryExecBatchSize.
+    ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut, bool allowBatching);
+
+    // Returns the number of units of work to ask '_root' for at a time. Returns 1 when results
+    // must be produced one at a time.
+    size_t _getWorkBatchSize(Snapshotted<BSONObj>* objOut, RecordId* dlOut) const;
 
     /**
      * New PlanExecutor instances are created with the static make() methods above.
@@ -528,6 +536,12 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Holds the ids of the results produced by a call to PlanStage::workBatch() on '_root' until
+    // they are moved to '_stash'. Kept as a member to avoid reallocating it for every batch. A
+    // batch is only produced once '_stash' is empty, so the results stashed from batches never
+    // use much more than PlanStage::kMaxWorkBatchBytes.
+    std::vector<WorkingSetID> _workBatch;
+
     enum { kUsable, kSaved, kDetached, kDisposed } _currentState = kUsable;
 
     // Set if this PlanExecutor is registered with the CursorManager.
@@ -29,6 +29,7 @@
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -62,10 +63,48 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecExternalSortThreads, int, 1);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecBatchSize, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCompileFilters, bool, false);
+
+namespace {
+
+const int kMaxFilterThreads = 64;
+
+class ExportedFilterThreadsParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedFilterThreadsParameter(const std::string& name, AtomicInt32* value)
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(), name, value) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 0 || potentialNewValue > kMaxFilterThreads) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << name() << " must be between 0 and "
+                                        << kMaxFilterThreads);
+        }
+
+        return Status::OK();
+    }
+};
+
+}  // namespace
+
+AtomicInt32 internalQueryCollScanFilterThreads(0);
+ExportedFilterThreadsParameter internalQueryCollScanFilterThreadsParam(
+    "internalQueryCollScanFilterThreads", &internalQueryCollScanFilterThreads);
+
+AtomicInt32 internalQueryIndexScanFilterThreads(0);
+ExportedFilterThreadsParameter internalQueryIndexScanFilterThreadsParam(
+    "internalQueryIndexScanFilterThreads", &internalQueryIndexScanFilterThreads);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetBufferSizeBytes, int, 100 * 1024 * 1024);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
@@ -74,5 +113,9 @@ MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupSpillPartitions, int, 16);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMergeThreads, int, 0);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 }  // namespace mongo
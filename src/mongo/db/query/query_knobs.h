@@ -101,9 +101,33 @@ extern AtomicBool internalQueryPlannerGenerateCoveredWholeIndexScans;
 
 extern AtomicInt32 internalQueryExecMaxBlockingSortBytes;
 
+// The number of threads a $sort that spills to disk may use to sort and write its runs.
+extern AtomicInt32 internalQueryExecExternalSortThreads;
+
 // Yield after this many "should yield?" checks.
 extern AtomicInt32 internalQueryExecYieldIterations;
 
+// The maximum number of units of work a PlanExecutor asks its plan stages to perform at a time
+// when it returns documents to its caller. Values above 1 let the stages pass batches of results
+// to each other rather than single results; see PlanStage::workBatch().
+extern AtomicInt32 internalQueryExecBatchSize;
+
+// If true, collection scans and fetches match documents against a CompiledMatchExpression built
+// from their filter, which looks up each top-level field a document's filter needs only once.
+extern AtomicBool internalQueryCompileFilters;
+
+// The number of extra threads a collection scan uses to apply its filter. Records are read on the
+// query's own thread and filtered in batches, with the results returned in the order they were
+// read. Zero means the filter is only applied on the query's own thread; at most 64. The threads
+// come from a pool shared by all scans, which runs at most 64 threads. Only used by plans which
+// run to completion, i.e. finds and counts without a limit that have a single candidate plan.
+extern AtomicInt32 internalQueryCollScanFilterThreads;
+
+// Like internalQueryCollScanFilterThreads, but for the filter an index scan applies to index keys.
+// Also at most 64, with the threads taken from the same shared pool, and only used under the same
+// conditions.
+extern AtomicInt32 internalQueryIndexScanFilterThreads;
+
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
@@ -117,4 +141,13 @@ extern AtomicInt32 internalInsertMaxBatchSize;
 
 extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
+// The number of hash partitions a $group spills its partially accumulated groups into when it
+// exceeds its memory limit. A value of 0 spills sorted runs of groups instead.
+extern AtomicInt32 internalDocumentSourceGroupSpillPartitions;
+
+// The number of workers a merging $group which cannot spill to disk accumulates the partial groups
+// from the shards on. A value of 0 or 1 merges on the thread running the pipeline. The workers run
+// on a pool shared by all merging $groups, which runs at most 64 threads.
+extern AtomicInt32 internalDocumentSourceGroupMergeThreads;
+
 }  // namespace mongo
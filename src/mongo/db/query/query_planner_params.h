@@ -98,6 +98,11 @@ struct QueryPlannerParams {
 
         // Set this to generate covered whole IXSCAN plans.
         GENERATE_COVERED_IXSCANS = 1 << 11,
+
+        // Set this if the caller consumes every result of the plan, so that scans may filter
+        // records ahead of their consumer on a worker pool. Only honored when the plan has no
+        // limit and is not chosen by a multi-plan trial.
+        ALLOW_PARALLEL_FILTER = 1 << 12,
     };
 
     // See Options enum above.
@@ -174,7 +174,8 @@ private:
  * of stages.
  */
 struct QuerySolution {
-    QuerySolution() : hasBlockingStage(false), indexFilterApplied(false) {}
+    QuerySolution()
+        : hasBlockingStage(false), indexFilterApplied(false), allowParallelFilter(false) {}
 
     // Owned here.
     std::unique_ptr<QuerySolutionNode> root;
@@ -197,6 +198,10 @@ struct QuerySolution {
     // if the planning process for this solution was based on filtered indices.
     bool indexFilterApplied;
 
+    // Whether the scans in this solution may filter records on a worker pool ahead of their
+    // consumer. Only set for plans that run to completion: no limit and no multi-plan trial.
+    bool allowParallelFilter;
+
     // Owned here. Used by the plan cache.
     std::unique_ptr<SolutionCacheData> cacheData;
 
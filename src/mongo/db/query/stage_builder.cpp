@@ -81,6 +81,7 @@ PlanStage* buildStages(OperationContext* opCtx,
             params.direction = (csn->direction == 1) ? CollectionScanParams::FORWARD
                                                      : CollectionScanParams::BACKWARD;
             params.maxScan = csn->maxScan;
+            params.allowParallelFilter = qsol.allowParallelFilter;
             return new CollectionScan(opCtx, params, ws, csn->filter.get());
         }
         case STAGE_IXSCAN: {
@@ -101,6 +102,7 @@ PlanStage* buildStages(OperationContext* opCtx,
             params.direction = ixn->direction;
             params.maxScan = ixn->maxScan;
             params.addKeyMetadata = ixn->addKeyMetadata;
+            params.allowParallelFilter = qsol.allowParallelFilter;
             return new IndexScan(opCtx, params, ws, ixn->filter.get());
         }
         case STAGE_FETCH: {
@@ -45,7 +45,11 @@ size_t getDocumentSize(const BSONObj& o) {
 
 }  // namespace
 
-OplogBufferBlockingQueue::OplogBufferBlockingQueue() : _queue(kOplogBufferSize, &getDocumentSize) {}
+OplogBufferBlockingQueue::OplogBufferBlockingQueue()
+    : OplogBufferBlockingQueue(kOplogBufferSize) {}
+
+OplogBufferBlockingQueue::OplogBufferBlockingQueue(std::size_t maxSize)
+    : _queue(maxSize, &getDocumentSize) {}
 
 void OplogBufferBlockingQueue::startup(OperationContext*) {}
 
@@ -76,7 +80,7 @@ bool OplogBufferBlockingQueue::isEmpty() const {
 }
 
 std::size_t OplogBufferBlockingQueue::getMaxSize() const {
-    return kOplogBufferSize;
+    return _queue.maxSize();
 }
 
 std::size_t OplogBufferBlockingQueue::getSize() const {
@@ -41,6 +41,11 @@ class OplogBufferBlockingQueue final : public OplogBuffer {
 public:
     OplogBufferBlockingQueue();
 
+    /**
+     * Limits the buffer to 'maxSize' bytes instead of the default 256MB.
+     */
+    explicit OplogBufferBlockingQueue(std::size_t maxSize);
+
     void startup(OperationContext* opCtx) override;
     void shutdown(OperationContext* opCtx) override;
     void pushEvenIfFull(OperationContext* opCtx, const Value& value) override;
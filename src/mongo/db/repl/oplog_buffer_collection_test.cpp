@@ -30,12 +30,15 @@
 
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/json.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/oplog_buffer_blocking_queue.h"
 #include "mongo/db/repl/oplog_buffer_collection.h"
+#include "mongo/db/repl/oplog_buffer_proxy.h"
 #include "mongo/db/repl/oplog_interface_local.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -1615,4 +1618,57 @@ TEST_F(OplogBufferCollectionTest, PeekFillsCacheWithDocumentsFromCollection) {
     _assertDocumentsEqualCache({}, oplogBuffer.getPeekCache_forTest());
 }
 
+TEST_F(OplogBufferCollectionTest, ProxySpillsToCollectionDuringBatchApplicationUntilDrained) {
+    auto nss = makeNamespace(_agent);
+    const std::vector<BSONObj> oplog = {
+        makeOplogEntry(1), makeOplogEntry(2), makeOplogEntry(3), makeOplogEntry(4)};
+
+    // The target buffer only has room for the first two entries.
+    auto target = stdx::make_unique<OplogBufferBlockingQueue>(
+        std::size_t(oplog[0].objsize() + oplog[1].objsize()));
+    auto targetPtr = target.get();
+    OplogBufferProxy proxy(std::move(target),
+                           stdx::make_unique<OplogBufferCollection>(_storageInterface, nss));
+    proxy.startup(_opCtx.get());
+
+    {
+        // Spilling and draining entries must not wait for the batch being applied.
+        auto applierClient = getServiceContext()->makeClient("applier");
+        auto applierOpCtx = applierClient->makeOperationContext();
+        Lock::ParallelBatchWriterMode pbwm(applierOpCtx->lockState());
+
+        for (const auto& entry : oplog) {
+            proxy.push(_opCtx.get(), entry);
+        }
+        ASSERT_EQUALS(2U, targetPtr->getCount());
+        ASSERT_EQUALS(2U, proxy.getOverflow()->getCount());
+
+        OplogBuffer::Value value;
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(proxy.peek(_opCtx.get(), &value));
+            ASSERT_TRUE(proxy.tryPop(_opCtx.get(), &value));
+            ASSERT_BSONOBJ_EQ(oplog[i], value);
+        }
+    }
+
+    // The entries spilled to the collection remain there until it has been drained.
+    auto countInCollection = [&] {
+        return unittest::assertGet(_storageInterface->getCollectionCount(_opCtx.get(), nss));
+    };
+    ASSERT_EQUALS(2U, countInCollection());
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(proxy.tryPop(_opCtx.get(), &value));
+    ASSERT_BSONOBJ_EQ(oplog[3], value);
+    ASSERT_TRUE(proxy.isEmpty());
+    ASSERT_EQUALS(0U, countInCollection());
+
+    // Once drained, entries go to the target buffer again.
+    proxy.push(_opCtx.get(), makeOplogEntry(5));
+    ASSERT_EQUALS(1U, targetPtr->getCount());
+    ASSERT_TRUE(proxy.getOverflow()->isEmpty());
+
+    proxy.shutdown(_opCtx.get());
+}
+
 }  // namespace
@@ -30,13 +30,52 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/repl/oplog_buffer_proxy.h"
+
+#include "mongo/db/concurrency/locker.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
 namespace repl {
 
-OplogBufferProxy::OplogBufferProxy(std::unique_ptr<OplogBuffer> target)
-    : _target(std::move(target)) {
+namespace {
+
+/**
+ * Lets the operation take locks while the applier holds the parallel batch writer mode lock, for
+ * as long as this object is in scope. The fetcher and the batcher use the overflow buffer while a
+ * batch is being applied, and must not wait for it to finish.
+ */
+class ShouldNotConflictWithSecondaryBatchApplicationBlock {
+    MONGO_DISALLOW_COPYING(ShouldNotConflictWithSecondaryBatchApplicationBlock);
+
+public:
+    explicit ShouldNotConflictWithSecondaryBatchApplicationBlock(OperationContext* opCtx)
+        : _lockState(opCtx ? opCtx->lockState() : nullptr),
+          _originalShouldConflict(_lockState &&
+                                  _lockState->shouldConflictWithSecondaryBatchApplication()) {
+        if (_lockState) {
+            _lockState->setShouldConflictWithSecondaryBatchApplication(false);
+        }
+    }
+
+    ~ShouldNotConflictWithSecondaryBatchApplicationBlock() {
+        if (_lockState) {
+            _lockState->setShouldConflictWithSecondaryBatchApplication(_originalShouldConflict);
+        }
+    }
+
+private:
+    Locker* const _lockState;
+    const bool _originalShouldConflict;
+};
+
+}  // namespace
+
+const Minutes OplogBufferProxy::kOverflowClearInterval{1};
+
+OplogBufferProxy::OplogBufferProxy(std::unique_ptr<OplogBuffer> target,
+                                   std::unique_ptr<OplogBuffer> overflow)
+    : _target(std::move(target)), _overflow(std::move(overflow)) {
     invariant(_target);
 }
 
@@ -44,30 +83,55 @@ OplogBuffer* OplogBufferProxy::getTarget() const {
     return _target.get();
 }
 
+OplogBuffer* OplogBufferProxy::getOverflow() const {
+    return _overflow.get();
+}
+
 void OplogBufferProxy::startup(OperationContext* opCtx) {
     _target->startup(opCtx);
+    if (_overflow) {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx);
+        _overflow->startup(opCtx);
+    }
+    const auto count = std::int64_t(getCount());
+    stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
+    _entriesBuffered = count;
 }
 
 void OplogBufferProxy::shutdown(OperationContext* opCtx) {
     {
-        stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
         stdx::lock_guard<stdx::mutex> frontLock(_lastPeekedMutex);
+        stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
         _lastPushed.reset();
         _lastPeeked.reset();
     }
     _target->shutdown(opCtx);
+    if (_overflow) {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx);
+        _overflow->shutdown(opCtx);
+    }
 }
 
 void OplogBufferProxy::pushEvenIfFull(OperationContext* opCtx, const Value& value) {
-    stdx::lock_guard<stdx::mutex> lk(_lastPushedMutex);
-    _lastPushed = value;
-    _target->pushEvenIfFull(opCtx, value);
+    stdx::lock_guard<stdx::mutex> pushLock(_pushMutex);
+    auto buffer = _getPushTarget_inlock(std::size_t(value.objsize()));
+    {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(
+            buffer == _overflow.get() ? opCtx : nullptr);
+        buffer->pushEvenIfFull(opCtx, value);
+    }
+    _setLastPushed_inlock(value, 1U);
 }
 
 void OplogBufferProxy::push(OperationContext* opCtx, const Value& value) {
-    stdx::lock_guard<stdx::mutex> lk(_lastPushedMutex);
-    _lastPushed = value;
-    _target->push(opCtx, value);
+    stdx::lock_guard<stdx::mutex> pushLock(_pushMutex);
+    auto buffer = _getPushTarget_inlock(std::size_t(value.objsize()));
+    {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(
+            buffer == _overflow.get() ? opCtx : nullptr);
+        buffer->push(opCtx, value);
+    }
+    _setLastPushed_inlock(value, 1U);
 }
 
 void OplogBufferProxy::pushAllNonBlocking(OperationContext* opCtx,
@@ -76,17 +140,31 @@ void OplogBufferProxy::pushAllNonBlocking(OperationContext* opCtx,
     if (begin == end) {
         return;
     }
-    stdx::lock_guard<stdx::mutex> lk(_lastPushedMutex);
-    _lastPushed = *(end - 1);
-    _target->pushAllNonBlocking(opCtx, begin, end);
+    std::size_t size = 0;
+    for (auto i = begin; i != end; ++i) {
+        size += std::size_t(i->objsize());
+    }
+    stdx::lock_guard<stdx::mutex> pushLock(_pushMutex);
+    // The whole batch goes to the same buffer to keep the entries in order.
+    auto buffer = _getPushTarget_inlock(size);
+    {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(
+            buffer == _overflow.get() ? opCtx : nullptr);
+        buffer->pushAllNonBlocking(opCtx, begin, end);
+    }
+    _setLastPushed_inlock(*(end - 1), std::size_t(end - begin));
 }
 
 void OplogBufferProxy::waitForSpace(OperationContext* opCtx, std::size_t size) {
+    if (_overflow) {
+        // Entries which do not fit in the target buffer are spilled to the overflow buffer.
+        return;
+    }
     _target->waitForSpace(opCtx, size);
 }
 
 bool OplogBufferProxy::isEmpty() const {
-    return _target->isEmpty();
+    return _target->isEmpty() && (!_overflow || _overflow->isEmpty());
 }
 
 std::size_t OplogBufferProxy::getMaxSize() const {
@@ -94,31 +172,54 @@ std::size_t OplogBufferProxy::getMaxSize() const {
 }
 
 std::size_t OplogBufferProxy::getSize() const {
-    return _target->getSize();
+    return _target->getSize() + (_overflow ? _overflow->getSize() : 0U);
 }
 
 std::size_t OplogBufferProxy::getCount() const {
-    return _target->getCount();
+    return _target->getCount() + (_overflow ? _overflow->getCount() : 0U);
 }
 
 void OplogBufferProxy::clear(OperationContext* opCtx) {
-    stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
+    stdx::lock_guard<stdx::mutex> pushLock(_pushMutex);
     stdx::lock_guard<stdx::mutex> frontLock(_lastPeekedMutex);
-    _lastPushed.reset();
-    _lastPeeked.reset();
     _target->clear(opCtx);
+    if (_overflow) {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx);
+        _overflow->clear(opCtx);
+        _lastOverflowClear = Date_t::now();
+    }
+    _lastPeeked.reset();
+    stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
+    _lastPushed.reset();
+    _entriesBuffered = 0;
 }
 
 bool OplogBufferProxy::tryPop(OperationContext* opCtx, Value* value) {
-    stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
-    stdx::lock_guard<stdx::mutex> frontLock(_lastPeekedMutex);
-    if (!_target->tryPop(opCtx, value)) {
-        return false;
+    bool poppedFromOverflow = false;
+    {
+        stdx::lock_guard<stdx::mutex> frontLock(_lastPeekedMutex);
+        // Entries in the target buffer are always older than those in the overflow buffer.
+        if (!_target->tryPop(opCtx, value)) {
+            if (!_overflow) {
+                return false;
+            }
+            ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx);
+            if (!_overflow->tryPop(opCtx, value)) {
+                return false;
+            }
+            poppedFromOverflow = true;
+        }
+        _lastPeeked.reset();
+
+        // Reset _lastPushed if underlying buffers are empty.
+        stdx::lock_guard<stdx::mutex> backLock(_lastPushedMutex);
+        if (--_entriesBuffered <= 0) {
+            _lastPushed.reset();
+        }
     }
-    _lastPeeked.reset();
-    // Reset _lastPushed if underlying buffer is empty.
-    if (_target->isEmpty()) {
-        _lastPushed.reset();
+
+    if (poppedFromOverflow) {
+        _clearOverflowIfDrained(opCtx);
     }
     return true;
 }
@@ -139,11 +240,17 @@ bool OplogBufferProxy::peek(OperationContext* opCtx, Value* value) {
         *value = *_lastPeeked;
         return true;
     }
-    if (_target->peek(opCtx, value)) {
-        _lastPeeked = *value;
-        return true;
+    if (!_target->peek(opCtx, value)) {
+        if (!_overflow) {
+            return false;
+        }
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx);
+        if (!_overflow->peek(opCtx, value)) {
+            return false;
+        }
     }
-    return false;
+    _lastPeeked = *value;
+    return true;
 }
 
 boost::optional<OplogBuffer::Value> OplogBufferProxy::lastObjectPushed(
@@ -155,6 +262,39 @@ boost::optional<OplogBuffer::Value> OplogBufferProxy::lastObjectPushed(
     return *_lastPushed;
 }
 
+OplogBuffer* OplogBufferProxy::_getPushTarget_inlock(std::size_t size) const {
+    if (!_overflow) {
+        return _target.get();
+    }
+    if (!_overflow->isEmpty() || _target->getSize() + size > _target->getMaxSize()) {
+        return _overflow.get();
+    }
+    return _target.get();
+}
+
+void OplogBufferProxy::_setLastPushed_inlock(const Value& value, std::size_t count) {
+    stdx::lock_guard<stdx::mutex> lk(_lastPushedMutex);
+    _entriesBuffered += std::int64_t(count);
+    // The entries may have been popped between being pushed and taking _lastPushedMutex, in which
+    // case tryPop() may already have reset _lastPushed.
+    if (_entriesBuffered > 0) {
+        _lastPushed = value;
+    }
+}
+
+void OplogBufferProxy::_clearOverflowIfDrained(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> pushLock(_pushMutex);
+    // Clearing a collection-backed buffer drops and recreates its collection, which must not
+    // happen on every drain when entries keep being spilled.
+    const auto now = Date_t::now();
+    if (now - _lastOverflowClear < kOverflowClearInterval || !_overflow->isEmpty()) {
+        return;
+    }
+    ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx);
+    _overflow->clear(opCtx);
+    _lastOverflowClear = now;
+}
+
 boost::optional<OplogBuffer::Value> OplogBufferProxy::getLastPeeked_forTest() const {
     stdx::lock_guard<stdx::mutex> lk(_lastPeekedMutex);
     return _lastPeeked;
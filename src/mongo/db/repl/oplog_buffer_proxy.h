@@ -34,6 +34,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/repl/oplog_buffer.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace repl {
@@ -43,18 +44,40 @@ class StorageInterface;
 /**
  * Oplog buffer proxy that caches front and back (most recently pushed) oplog entries in the target
  * oplog buffer.
+ *
+ * If an overflow oplog buffer is provided, entries are spilled to it instead of waiting for space
+ * whenever the target buffer is full. Once spilling starts, every entry is pushed to the overflow
+ * buffer until it has been drained again, so that entries are always popped in the order in which
+ * they were pushed. The overflow buffer is cleared when it has been drained, which lets a
+ * collection-backed overflow buffer discard the entries it has already returned. Clearing a
+ * collection-backed buffer drops and recreates its collection, so this is done at most once per
+ * kOverflowClearInterval; entries popped in the meantime are kept until a later drain.
+ *
+ * Reads and writes of the overflow buffer do not conflict with secondary batch application, so
+ * that spilling and draining entries never waits for the batch being applied.
  */
 class OplogBufferProxy : public OplogBuffer {
     MONGO_DISALLOW_COPYING(OplogBufferProxy);
 
 public:
-    explicit OplogBufferProxy(std::unique_ptr<OplogBuffer> target);
+    /**
+     * Minimum time between two clears of a drained overflow buffer.
+     */
+    static const Minutes kOverflowClearInterval;
+
+    explicit OplogBufferProxy(std::unique_ptr<OplogBuffer> target,
+                              std::unique_ptr<OplogBuffer> overflow = nullptr);
 
     /**
      * Returns target oplog buffer.
      */
     OplogBuffer* getTarget() const;
 
+    /**
+     * Returns overflow oplog buffer. May be null.
+     */
+    OplogBuffer* getOverflow() const;
+
     void startup(OperationContext* opCtx) override;
     void shutdown(OperationContext* opCtx) override;
     void pushEvenIfFull(OperationContext* opCtx, const Value& value) override;
@@ -77,15 +100,52 @@ public:
     boost::optional<Value> getLastPeeked_forTest() const;
 
 private:
+    /**
+     * Returns the buffer which entries of 'size' bytes should be pushed to. Caller must hold
+     * _pushMutex.
+     */
+    OplogBuffer* _getPushTarget_inlock(std::size_t size) const;
+
+    /**
+     * Counts 'count' entries as pushed and records 'value', the last of them, as the last entry
+     * pushed, unless it has already been popped. Caller must hold _pushMutex.
+     */
+    void _setLastPushed_inlock(const Value& value, std::size_t count);
+
+    /**
+     * Clears the overflow buffer if no entries have been pushed to it since it was drained, and it
+     * was last cleared at least kOverflowClearInterval ago.
+     */
+    void _clearOverflowIfDrained(OperationContext* opCtx);
+
     // Target oplog buffer. Owned by us.
     std::unique_ptr<OplogBuffer> _target;
 
-    // If both mutexes have to be acquired, acquire _lastPushedMutex first.
+    // Oplog buffer for entries which do not fit in the target buffer. Owned by us. May be null.
+    std::unique_ptr<OplogBuffer> _overflow;
+
+    // Serializes pushes, and clearing the overflow buffer, with each other. Held while the
+    // entries are written to the underlying buffers.
+    stdx::mutex _pushMutex;
+
+    // When the overflow buffer was last cleared. Guarded by _pushMutex.
+    Date_t _lastOverflowClear;
+
+    // Never held while reading from or writing to the underlying buffers, so that callers of
+    // lastObjectPushed() and waitForData() do not wait for storage.
     mutable stdx::mutex _lastPushedMutex;
     boost::optional<Value> _lastPushed;
 
+    // Number of entries in the underlying buffers, counted here so that _lastPushed can be reset
+    // without asking the buffers whether they are empty. An entry may be popped before its push is
+    // counted, so this can briefly be negative.
+    std::int64_t _entriesBuffered = 0;
+
     mutable stdx::mutex _lastPeekedMutex;
     boost::optional<Value> _lastPeeked;
+
+    // If several mutexes have to be acquired, acquire them in this order: _pushMutex,
+    // _lastPeekedMutex, _lastPushedMutex.
 };
 
 }  // namespace repl
@@ -90,6 +90,7 @@ public:
         return values.size();
     }
     void clear(OperationContext*) override {
+        clearCalled = true;
         values.clear();
     }
     bool tryPop(OperationContext* opCtx, Value* value) override {
@@ -124,6 +125,7 @@ public:
     bool startupCalled = false;
     bool shutdownCalled = false;
     bool waitForSpaceCalled = false;
+    bool clearCalled = false;
     bool waitForDataCalled = false;
     bool tryPopCalled = false;
     bool peekCalled = false;
@@ -379,4 +381,99 @@ TEST_F(OplogBufferProxyTest, TryPopClearsCachedFrontValue) {
     ASSERT_EQUALS(boost::none, _proxy->getLastPeeked_forTest());
 }
 
+TEST_F(OplogBufferProxyTest, PushSpillsToOverflowBufferOnlyWhenTargetIsFull) {
+    auto target = stdx::make_unique<OplogBufferMock>();
+    auto overflow = stdx::make_unique<OplogBufferMock>();
+    auto targetPtr = target.get();
+    auto overflowPtr = overflow.get();
+    OplogBufferProxy proxy(std::move(target), std::move(overflow));
+    ASSERT_EQUALS(overflowPtr, proxy.getOverflow());
+
+    OplogBuffer::Batch values = {BSON("x" << 1), BSON("x" << 2), BSON("x" << 3)};
+    targetPtr->maxSize = std::size_t(values[0].objsize() + values[1].objsize());
+
+    proxy.pushAllNonBlocking(_opCtx, values.cbegin(), values.cbegin() + 2);
+    ASSERT_EQUALS(2U, targetPtr->getCount());
+    ASSERT_TRUE(overflowPtr->isEmpty());
+
+    // The target buffer is full so neither the fetcher nor the push should wait for space.
+    proxy.waitForSpace(_opCtx, std::size_t(values[2].objsize()));
+    ASSERT_FALSE(targetPtr->waitForSpaceCalled);
+    proxy.push(_opCtx, values[2]);
+    ASSERT_EQUALS(2U, targetPtr->getCount());
+    ASSERT_EQUALS(1U, overflowPtr->getCount());
+    ASSERT_EQUALS(3U, proxy.getCount());
+    ASSERT_EQUALS(targetPtr->getSize() + overflowPtr->getSize(), proxy.getSize());
+}
+
+TEST_F(OplogBufferProxyTest, OverflowBufferIsDrainedInPushOrderBeforeTargetIsUsedAgain) {
+    auto target = stdx::make_unique<OplogBufferMock>();
+    auto overflow = stdx::make_unique<OplogBufferMock>();
+    auto targetPtr = target.get();
+    auto overflowPtr = overflow.get();
+    OplogBufferProxy proxy(std::move(target), std::move(overflow));
+
+    auto value1 = BSON("x" << 1);
+    targetPtr->maxSize = std::size_t(value1.objsize());
+    proxy.push(_opCtx, value1);
+    proxy.push(_opCtx, BSON("x" << 2));
+
+    // Popping {x: 1} makes room in the target buffer but entries must keep going to the overflow
+    // buffer while it is not empty.
+    OplogBuffer::Value value;
+    ASSERT_TRUE(proxy.tryPop(_opCtx, &value));
+    ASSERT_BSONOBJ_EQ(value1, value);
+    proxy.push(_opCtx, BSON("x" << 3));
+    ASSERT_TRUE(targetPtr->isEmpty());
+    ASSERT_EQUALS(2U, overflowPtr->getCount());
+
+    ASSERT_TRUE(proxy.peek(_opCtx, &value));
+    ASSERT_BSONOBJ_EQ(BSON("x" << 2), value);
+    ASSERT_TRUE(proxy.tryPop(_opCtx, &value));
+    ASSERT_BSONOBJ_EQ(BSON("x" << 2), value);
+    ASSERT_FALSE(overflowPtr->clearCalled);
+    ASSERT_TRUE(proxy.tryPop(_opCtx, &value));
+    ASSERT_BSONOBJ_EQ(BSON("x" << 3), value);
+    ASSERT_TRUE(proxy.isEmpty());
+
+    // The overflow buffer is cleared once drained, so it can discard the entries it returned.
+    ASSERT_TRUE(overflowPtr->clearCalled);
+    ASSERT_FALSE(targetPtr->clearCalled);
+    ASSERT_EQUALS(boost::none, proxy.lastObjectPushed(_opCtx));
+
+    // Once the overflow buffer has been drained, entries go to the target buffer again.
+    proxy.push(_opCtx, BSON("x" << 4));
+    ASSERT_EQUALS(1U, targetPtr->getCount());
+    ASSERT_TRUE(overflowPtr->isEmpty());
+}
+
+TEST_F(OplogBufferProxyTest, DrainedOverflowBufferIsNotClearedAgainWithinClearInterval) {
+    auto target = stdx::make_unique<OplogBufferMock>();
+    auto overflow = stdx::make_unique<OplogBufferMock>();
+    auto targetPtr = target.get();
+    auto overflowPtr = overflow.get();
+    OplogBufferProxy proxy(std::move(target), std::move(overflow));
+
+    auto value1 = BSON("x" << 1);
+    targetPtr->maxSize = std::size_t(value1.objsize());
+    OplogBuffer::Value value;
+    for (int cycle = 0; cycle < 2; ++cycle) {
+        overflowPtr->clearCalled = false;
+        proxy.push(_opCtx, value1);
+        proxy.push(_opCtx, BSON("x" << 2));
+        ASSERT_EQUALS(1U, overflowPtr->getCount());
+        ASSERT_BSONOBJ_EQ(BSON("x" << 2), *proxy.lastObjectPushed(_opCtx));
+
+        ASSERT_TRUE(proxy.tryPop(_opCtx, &value));
+        ASSERT_TRUE(proxy.tryPop(_opCtx, &value));
+        ASSERT_BSONOBJ_EQ(BSON("x" << 2), value);
+        ASSERT_TRUE(proxy.isEmpty());
+        ASSERT_EQUALS(boost::none, proxy.lastObjectPushed(_opCtx));
+
+        // Only the first drain clears the overflow buffer. The second one follows it within
+        // kOverflowClearInterval.
+        ASSERT_EQUALS(cycle == 0, overflowPtr->clearCalled);
+    }
+}
+
 }  // namespace
@@ -135,6 +135,13 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBuffer,
 // Set this to specify size of read ahead buffer in the OplogBufferCollection.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBufferPeekCacheSize, int, 10000);
 
+// Set this to true to spill fetched oplog entries to a collection when the in-memory oplog buffer
+// used in steady state replication is full, instead of making the oplog fetcher wait for space.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(steadyStateOplogBufferSpillToCollection, bool, false);
+
+// Namespace of the collection that steady state oplog entries are spilled to.
+const char kSteadyStateOplogBufferSpillNamespace[] = "local.temp_oplog_buffer_spill";
+
 // Set this to specify maximum number of times the oplog fetcher will consecutively restart the
 // oplog tailing query on non-cancellation errors.
 server_parameter_storage_type<int, ServerParameterType::kStartupAndRuntime>::value_type
@@ -871,6 +878,17 @@ std::unique_ptr<OplogBuffer> ReplicationCoordinatorExternalStateImpl::makeInitia
 
 std::unique_ptr<OplogBuffer> ReplicationCoordinatorExternalStateImpl::makeSteadyStateOplogBuffer(
     OperationContext* opCtx) const {
+    if (steadyStateOplogBufferSpillToCollection) {
+        invariant(initialSyncOplogBufferPeekCacheSize >= 0);
+        OplogBufferCollection::Options options;
+        options.peekCacheSize = std::size_t(initialSyncOplogBufferPeekCacheSize);
+        return stdx::make_unique<OplogBufferProxy>(
+            stdx::make_unique<OplogBufferBlockingQueue>(),
+            stdx::make_unique<OplogBufferCollection>(
+                StorageInterface::get(opCtx),
+                NamespaceString(kSteadyStateOplogBufferSpillNamespace),
+                options));
+    }
     return stdx::make_unique<OplogBufferBlockingQueue>();
 }
 
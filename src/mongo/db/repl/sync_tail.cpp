@@ -72,6 +72,7 @@
 #include "mongo/db/session_txn_record.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -118,6 +119,33 @@ public:
 
 } exportedWriterThreadCountParam;
 
+/**
+ * The number of threads the batcher uses to page in the index entries and documents needed by a
+ * batch before it is applied, on storage engines which do not prefetch synchronously from the
+ * writer threads (i.e. all but MMAPv1). Zero, the default, disables this prefetching.
+ */
+int replPrefetcherThreadCount = 0;
+
+class ExportedPrefetcherThreadCountParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupOnly> {
+public:
+    ExportedPrefetcherThreadCountParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(),
+              "replPrefetcherThreadCount",
+              &replPrefetcherThreadCount) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 0 || potentialNewValue > 256) {
+            return Status(ErrorCodes::BadValue,
+                          "replPrefetcherThreadCount must be between 0 and 256");
+        }
+
+        return Status::OK();
+    }
+
+} exportedPrefetcherThreadCountParam;
+
 class ExportedBatchLimitOperationsParameter
     : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
 public:
@@ -137,6 +165,10 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+// The number of batches the batcher thread may have parsed and ready to apply while the applier is
+// still busy with an earlier batch. Values below 1 are treated as 1.
+MONGO_EXPORT_SERVER_PARAMETER(replReadyBatchLimit, int, 1);
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
@@ -149,6 +181,12 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+
+// The number of oplog entries given to the busiest writer thread, summed over all batches. The
+// parallelism achieved by oplog application is the ratio of "repl.apply.ops" to this.
+Counter64 busiestWriterOpsStats;
+ServerStatusMetricField<Counter64> displayBusiestWriterOps("repl.apply.busiestWriterOps",
+                                                           &busiestWriterOpsStats);
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -396,8 +434,10 @@ Status SyncTail::syncApply(OperationContext* opCtx,
 
 namespace {
 
-// The pool threads call this to prefetch each op
-void prefetchOp(const BSONObj& op) {
+// The pool threads call this to prefetch each op. When prefetching for a batch which will only be
+// applied after the current one, 'conflictWithBatchApplication' must be false so that the reads
+// don't wait for the current batch to finish.
+void prefetchOp(const BSONObj& op, bool conflictWithBatchApplication) {
     initializePrefetchThread();
 
     const char* ns = op.getStringField("ns");
@@ -407,6 +447,8 @@ void prefetchOp(const BSONObj& op) {
             // for multiple prefetches if they are for the same database.
             const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
             OperationContext& opCtx = *opCtxPtr;
+            opCtx.lockState()->setShouldConflictWithSecondaryBatchApplication(
+                conflictWithBatchApplication);
             AutoGetCollectionForReadCommand ctx(&opCtx, NamespaceString(ns));
             Database* db = ctx.getDb();
             if (db) {
@@ -425,11 +467,44 @@ void prefetchOp(const BSONObj& op) {
 void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherPool) {
     invariant(prefetcherPool);
     for (auto&& op : ops) {
-        prefetcherPool->schedule(&prefetchOp, op.raw);
+        prefetcherPool->schedule(&prefetchOp, op.raw, true);
     }
     prefetcherPool->join();
 }
 
+}  // namespace
+
+void prefetchOpsAhead(const std::vector<OplogEntry>& ops, OldThreadPool* prefetcherPool) {
+    prefetchOpsAhead(ops, prefetcherPool, &prefetchOp);
+}
+
+void prefetchOpsAhead(const std::vector<OplogEntry>& ops,
+                      OldThreadPool* prefetcherPool,
+                      PrefetchOpFn prefetchOpFn) {
+    invariant(prefetcherPool);
+    // If the pool is still more than a batch behind, it would only page in data which the writer
+    // threads already had to read themselves.
+    if (prefetcherPool->getStats().numPendingTasks > ops.size()) {
+        return;
+    }
+    for (auto&& op : ops) {
+        if (isCrudOpType(op.raw.getStringField("op"))) {
+            prefetcherPool->schedule([prefetchOpFn, op] { prefetchOpFn(op.raw, false); });
+        }
+    }
+}
+
+std::unique_ptr<OldThreadPool> makePrefetcherPool() {
+    if (replPrefetcherThreadCount == 0 ||
+        getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+        // MMAPv1 prefetches each batch from the writer threads just before applying it.
+        return nullptr;
+    }
+    return stdx::make_unique<OldThreadPool>(replPrefetcherThreadCount, "repl prefetch worker ");
+}
+
+namespace {
+
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
@@ -611,16 +686,35 @@ private:
     StringMap<CollectionProperties> _cache;
 };
 
+/**
+ * Returns the index of the writer vector which has been given the fewest operations so far.
+ */
+uint32_t leastLoadedWriter(const std::vector<MultiApplier::OperationPtrs>& writerVectors) {
+    uint32_t leastLoaded = 0;
+    for (uint32_t i = 1; i < writerVectors.size(); ++i) {
+        if (writerVectors[i].size() < writerVectors[leastLoaded].size()) {
+            leastLoaded = i;
+        }
+    }
+    return leastLoaded;
+}
+
 // This only modifies the isForCappedCollection field on each op. It does not alter the ops vector
 // in any other way.
+//
+// Operations which may conflict with each other are given the same hash, and must be applied in
+// order by the same writer. Operations with different hashes are independent, so rather than
+// always sending a hash to writer 'hash % numWriters', which leaves writers idle when the hashes
+// in a batch happen to collide, each hash is given to the least loaded writer the first time it is
+// seen in the batch.
 void fillWriterVectors(OperationContext* opCtx,
                        MultiApplier::Operations* ops,
                        std::vector<MultiApplier::OperationPtrs>* writerVectors) {
     const bool supportsDocLocking =
         getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
-    const uint32_t numWriters = writerVectors->size();
 
     CachedCollectionProperties collPropertiesCache;
+    stdx::unordered_map<uint32_t, uint32_t> writerForHash;
 
     for (auto&& op : *ops) {
         StringMapTraits::HashedKey hashedNs(op.getNamespace().ns());
@@ -649,7 +743,12 @@ void fillWriterVectors(OperationContext* opCtx,
             }
         }
 
-        auto& writer = (*writerVectors)[hash % numWriters];
+        auto it = writerForHash.find(hash);
+        if (it == writerForHash.end()) {
+            it = writerForHash.emplace(hash, leastLoadedWriter(*writerVectors)).first;
+        }
+
+        auto& writer = (*writerVectors)[it->second];
         if (writer.empty())
             writer.reserve(8);  // skip a few growth rounds.
         writer.push_back(&op);
@@ -709,29 +808,51 @@ void tryToGoLiveAsASecondary(OperationContext* opCtx, ReplicationCoordinator* re
 }
 }
 
+void SyncTail::ReadyBatchQueue::push(OpQueue ops, int limit) {
+    const size_t maxBatches = static_cast<size_t>(std::max(1, limit));
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _cv.wait(lk, [&] { return _batches.size() < maxBatches; });
+    _batches.push_back(std::move(ops));
+    _cv.notify_all();
+}
+
+SyncTail::OpQueue SyncTail::ReadyBatchQueue::pop(Seconds maxWaitTime) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_batches.empty()) {
+        // We intentionally don't care about whether this returns due to signaling or timeout
+        // since we do the same thing either way: return the oldest ready batch, if any.
+        (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
+        if (_batches.empty()) {
+            return {};
+        }
+    }
+
+    OpQueue ops = std::move(_batches.front());
+    _batches.pop_front();
+    _cv.notify_all();
+
+    return ops;
+}
+
+size_t SyncTail::ReadyBatchQueue::size() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _batches.size();
+}
+
 class SyncTail::OpQueueBatcher {
     MONGO_DISALLOW_COPYING(OpQueueBatcher);
 
 public:
-    OpQueueBatcher(SyncTail* syncTail) : _syncTail(syncTail), _thread([this] { run(); }) {}
+    OpQueueBatcher(SyncTail* syncTail)
+        : _syncTail(syncTail), _prefetcherPool(makePrefetcherPool()), _thread([this] { run(); }) {}
     ~OpQueueBatcher() {
         invariant(_isDead);
         _thread.join();
     }
 
     OpQueue getNextBatch(Seconds maxWaitTime) {
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
-        if (_ops.empty() && !_ops.mustShutdown()) {
-            // We intentionally don't care about whether this returns due to signaling or timeout
-            // since we do the same thing either way: return whatever is in _ops.
-            (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
-        }
-
-        OpQueue ops = std::move(_ops);
-        _ops = {};
-        _cv.notify_all();
-
-        return ops;
+        return _readyBatches.pop(maxWaitTime);
     }
 
 private:
@@ -767,13 +888,23 @@ private:
                 continue;  // Don't emit empty batches.
             }
 
-            stdx::unique_lock<stdx::mutex> lk(_mutex);
-            // Block until the previous batch has been taken.
-            _cv.wait(lk, [&] { return _ops.empty(); });
-            _ops = std::move(ops);
-            _cv.notify_all();
-            if (_ops.mustShutdown()) {
+            if (_prefetcherPool && !ops.empty()) {
+                // Page in what this batch needs while the batches ahead of it are applied.
+                prefetchOpsAhead(ops.getBatch(), _prefetcherPool.get());
+            }
+
+            // The applier may destroy this batcher as soon as it sees the shutdown batch, so mark
+            // it dead before handing that batch over.
+            const bool mustShutdown = ops.mustShutdown();
+            if (mustShutdown) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
                 _isDead = true;
+            }
+
+            // Block until there is room for another ready batch. Batches are only limited by
+            // count, since each is already limited in size by 'batchLimits'.
+            _readyBatches.push(std::move(ops), replReadyBatchLimit.load());
+            if (mustShutdown) {
                 return;
             }
         }
@@ -781,9 +912,12 @@ private:
 
     SyncTail* const _syncTail;
 
-    stdx::mutex _mutex;  // Guards _ops.
-    stdx::condition_variable _cv;
-    OpQueue _ops;
+    // Null unless prefetching ahead of application is enabled. See replPrefetcherThreadCount.
+    const std::unique_ptr<OldThreadPool> _prefetcherPool;
+
+    ReadyBatchQueue _readyBatches;
+
+    stdx::mutex _mutex;  // Guards _isDead.
 
     // This only exists so the destructor invariants rather than deadlocking.
     // TODO remove once we trust noexcept enough to mark oplogApplication() as noexcept.
@@ -1349,6 +1483,14 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         scheduleWritesToOplog(opCtx, workerPool, ops);
         fillWriterVectors(opCtx, &ops, &writerVectors);
 
+        size_t busiestWriterOps = 0;
+        for (auto&& writer : writerVectors) {
+            busiestWriterOps = std::max(busiestWriterOps, writer.size());
+        }
+        busiestWriterOpsStats.increment(busiestWriterOps);
+        LOG(2) << "replication batch of " << ops.size() << " operations has at most "
+               << busiestWriterOps << " operations per writer thread";
+
         // Wait for writes to finish before applying ops.
         workerPool->join();
 
@@ -35,8 +35,11 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/repl/multiapplier.h"
 #include "mongo/db/repl/oplog_entry.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/old_thread_pool.h"
+#include "mongo/util/duration.h"
 
 namespace mongo {
 
@@ -180,6 +183,38 @@ public:
         bool _mustShutdown = false;
     };
 
+    /**
+     * Batches which have been parsed by the batcher thread and are waiting to be applied, oldest
+     * first. Lets the batcher get several batches ahead of the applier.
+     */
+    class ReadyBatchQueue {
+        MONGO_DISALLOW_COPYING(ReadyBatchQueue);
+
+    public:
+        ReadyBatchQueue() = default;
+
+        /**
+         * Blocks until fewer than 'limit' batches are waiting, then adds 'ops' as the newest
+         * batch. Values of 'limit' below 1 are treated as 1.
+         */
+        void push(OpQueue ops, int limit);
+
+        /**
+         * Removes and returns the oldest batch, waiting up to 'maxWaitTime' for one to be pushed.
+         * Returns an empty batch if there is none by then.
+         */
+        OpQueue pop(Seconds maxWaitTime);
+
+        size_t size() const;
+
+    private:
+        mutable stdx::mutex _mutex;  // Guards _batches.
+        stdx::condition_variable _cv;
+
+        // A batch with the mustShutdown flag set is always the last one.
+        std::deque<OpQueue> _batches;
+    };
+
     struct BatchLimits {
         size_t bytes = replBatchLimitBytes;
         size_t ops = replBatchLimitOperations.load();
@@ -257,6 +292,30 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
                               MultiApplier::Operations ops,
                               MultiApplier::ApplyOperationFn applyOperation);
 
+/**
+ * Creates the thread pool which pages in the data needed by batches ahead of their application.
+ * Returns null if replPrefetcherThreadCount is 0, or on MMAPv1 which prefetches each batch just
+ * before applying it.
+ */
+std::unique_ptr<OldThreadPool> makePrefetcherPool();
+
+/**
+ * Type of function the prefetcher pool threads run for each op. 'conflictWithBatchApplication'
+ * is false for the ops of batches which are applied after the current one, so that their reads
+ * don't wait for the current batch to finish.
+ */
+using PrefetchOpFn = stdx::function<void(const BSONObj& op, bool conflictWithBatchApplication)>;
+
+/**
+ * Schedules 'prefetchOpFn' on 'prefetcherPool' for each CRUD op in 'ops', a batch which is not
+ * being applied yet, without waiting for them. Skips the whole batch if the pool has more tasks
+ * pending than 'ops' has ops. The first overload pages in the op's index entries and document.
+ */
+void prefetchOpsAhead(const std::vector<OplogEntry>& ops, OldThreadPool* prefetcherPool);
+void prefetchOpsAhead(const std::vector<OplogEntry>& ops,
+                      OldThreadPool* prefetcherPool,
+                      PrefetchOpFn prefetchOpFn);
+
 // These free functions are used by the thread pool workers to write ops to the db.
 // They consume the passed in OperationPtrs and callers should not make any assumptions about the
 // state of the container after calling. However, these functions cannot modify the pointed-to
@@ -46,6 +46,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/prefetch.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
@@ -59,10 +60,13 @@
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/repl/sync_tail.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/old_thread_pool.h"
 #include "mongo/util/md5.hpp"
@@ -433,9 +437,7 @@ TEST_F(SyncTailTest,
 
 TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceHash) {
     // This test relies on implementation details of how multiApply uses hashing to distribute ops
-    // to threads. It is possible for this test to fail, even if the implementation of multiApply is
-    // correct. If it fails, consider adjusting the namespace names (to adjust the hash values) or
-    // the number of threads in the pool.
+    // to threads: operations with different hashes are given to the least loaded writer thread.
     NamespaceString nss1("test.t0");
     NamespaceString nss2("test.t1");
     OldThreadPool writerPool(2);
@@ -494,6 +496,53 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1].doc);
 }
 
+TEST_F(SyncTailTest, MultiApplySpreadsIndependentNamespacesAcrossAllWriterThreads) {
+    // Whatever their hashes, four namespaces applied by four writer threads should each get a
+    // writer of their own, while the operations on each namespace stay together and in order.
+    const size_t numWriters = 4;
+    OldThreadPool writerPool(numWriters);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+    _storageInterface->insertDocumentsFn =
+        [](OperationContext*, const NamespaceString&, const std::vector<InsertStatement>&) {
+            return Status::OK();
+        };
+
+    MultiApplier::Operations ops;
+    long long seconds = 0;
+    for (int round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < numWriters; ++i) {
+            NamespaceString nss("test.t" + std::to_string(i));
+            ops.push_back(makeInsertDocumentOplogEntry(
+                {Timestamp(Seconds(++seconds), 0), 1LL}, nss, BSON("x" << round)));
+        }
+    }
+
+    auto lastOpTime =
+        unittest::assertGet(multiApply(_opCtx.get(), &writerPool, ops, applyOperationFn));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_EQUALS(numWriters, operationsApplied.size());
+    for (auto&& operationsAppliedByThread : operationsApplied) {
+        ASSERT_EQUALS(2U, operationsAppliedByThread.size());
+        const auto& first = operationsAppliedByThread[0];
+        const auto& second = operationsAppliedByThread[1];
+        ASSERT_EQUALS(first.getNamespace(), second.getNamespace());
+        ASSERT_LESS_THAN(first.getOpTime(), second.getOpTime());
+    }
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
@@ -1047,6 +1096,199 @@ TEST_F(SyncTailTest,
     ASSERT_EQUALS(ErrorCodes::CollectionIsEmpty, iter->next().getStatus());
 }
 
+SyncTail::OpQueue makeReadyBatch(int id) {
+    SyncTail::OpQueue ops;
+    ops.emplace_back(makeSizedInsertOp(NamespaceString("test.t"), 1, id).raw);
+    return ops;
+}
+
+void assertReadyBatch(int id, const SyncTail::OpQueue& ops) {
+    ASSERT_EQUALS(1U, ops.getCount());
+    ASSERT_BSONOBJ_EQ(makeSizedInsertOp(NamespaceString("test.t"), 1, id).raw, ops.front().raw);
+}
+
+TEST(SyncTailReadyBatchQueueTest, HoldsSeveralBatchesInOrder) {
+    SyncTail::ReadyBatchQueue readyBatches;
+    readyBatches.push(makeReadyBatch(1), 3);
+    readyBatches.push(makeReadyBatch(2), 3);
+    readyBatches.push(makeReadyBatch(3), 3);
+    ASSERT_EQUALS(3U, readyBatches.size());
+
+    assertReadyBatch(1, readyBatches.pop(Seconds(0)));
+    assertReadyBatch(2, readyBatches.pop(Seconds(0)));
+    assertReadyBatch(3, readyBatches.pop(Seconds(0)));
+    ASSERT_EQUALS(0U, readyBatches.size());
+}
+
+TEST(SyncTailReadyBatchQueueTest, PopReturnsEmptyBatchWhenNoneIsReady) {
+    SyncTail::ReadyBatchQueue readyBatches;
+    auto ops = readyBatches.pop(Seconds(0));
+    ASSERT_TRUE(ops.empty());
+    ASSERT_FALSE(ops.mustShutdown());
+}
+
+TEST(SyncTailReadyBatchQueueTest, PushBlocksOnceReadyBatchLimitIsReached) {
+    SyncTail::ReadyBatchQueue readyBatches;
+    readyBatches.push(makeReadyBatch(1), 2);
+    readyBatches.push(makeReadyBatch(2), 2);
+
+    stdx::thread batcher([&] { readyBatches.push(makeReadyBatch(3), 2); });
+    auto joinGuard = MakeGuard([&] { batcher.join(); });
+    ASSERT_EQUALS(2U, readyBatches.size());
+
+    // Taking a batch makes room for the blocked one, which is queued behind the older batch.
+    assertReadyBatch(1, readyBatches.pop(Seconds(0)));
+    batcher.join();
+    joinGuard.Dismiss();
+    ASSERT_EQUALS(2U, readyBatches.size());
+    assertReadyBatch(2, readyBatches.pop(Seconds(0)));
+    assertReadyBatch(3, readyBatches.pop(Seconds(0)));
+}
+
+TEST(SyncTailReadyBatchQueueTest, LimitBelowOneHoldsOneBatch) {
+    SyncTail::ReadyBatchQueue readyBatches;
+    readyBatches.push(makeReadyBatch(1), 0);
+    ASSERT_EQUALS(1U, readyBatches.size());
+
+    stdx::thread batcher([&] { readyBatches.push(makeReadyBatch(2), 0); });
+    auto joinGuard = MakeGuard([&] { batcher.join(); });
+    ASSERT_EQUALS(1U, readyBatches.size());
+
+    assertReadyBatch(1, readyBatches.pop(Seconds(0)));
+    batcher.join();
+    joinGuard.Dismiss();
+    assertReadyBatch(2, readyBatches.pop(Seconds(0)));
+}
+
+TEST(SyncTailReadyBatchQueueTest, ShutdownBatchIsReturnedAfterReadyBatches) {
+    SyncTail::ReadyBatchQueue readyBatches;
+    readyBatches.push(makeReadyBatch(1), 3);
+    readyBatches.push(makeReadyBatch(2), 3);
+    SyncTail::OpQueue shutdownBatch;
+    shutdownBatch.setMustShutdownFlag();
+    readyBatches.push(std::move(shutdownBatch), 3);
+
+    // The applier must apply everything the batcher read before it learns about the shutdown.
+    assertReadyBatch(1, readyBatches.pop(Seconds(0)));
+    assertReadyBatch(2, readyBatches.pop(Seconds(0)));
+    auto ops = readyBatches.pop(Seconds(0));
+    ASSERT_TRUE(ops.empty());
+    ASSERT_TRUE(ops.mustShutdown());
+}
+
+TEST(SyncTailPrefetchTest, PrefetchTakesIntentLockOnDocumentLockingEngines) {
+    ASSERT_EQUALS(MODE_IS, prefetchCollectionLockMode(true));
+    ASSERT_EQUALS(MODE_S, prefetchCollectionLockMode(false));
+}
+
+TEST_F(SyncTailTest, MakePrefetcherPoolHonorsThreadCount) {
+    ServerParameter* threadCount =
+        ServerParameterSet::getGlobal()->getMap().find("replPrefetcherThreadCount")->second;
+    ASSERT_FALSE(makePrefetcherPool());
+
+    ASSERT_OK(threadCount->setFromString("2"));
+    ON_BLOCK_EXIT([threadCount] { threadCount->setFromString("0").transitional_ignore(); });
+    auto pool = makePrefetcherPool();
+    ASSERT_TRUE(pool);
+    pool->join();
+}
+
+TEST_F(SyncTailTest, PrefetchOpsAheadSchedulesCrudOpsWithoutConflictingWithBatchApplication) {
+    NamespaceString nss("test.t");
+    std::vector<OplogEntry> ops = {
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss, BSON("_id" << 1)),
+        makeCreateCollectionOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss, BSON("_id" << 2))};
+
+    stdx::mutex mutex;
+    std::vector<BSONObj> prefetched;
+    OldThreadPool pool(1);
+    prefetchOpsAhead(ops, &pool, [&](const BSONObj& op, bool conflictWithBatchApplication) {
+        ASSERT_FALSE(conflictWithBatchApplication);
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        prefetched.push_back(op);
+    });
+    pool.join();
+
+    ASSERT_EQUALS(2U, prefetched.size());
+    ASSERT_BSONOBJ_EQ(ops[0].raw, prefetched[0]);
+    ASSERT_BSONOBJ_EQ(ops[2].raw, prefetched[1]);
+}
+
+TEST_F(SyncTailTest, PrefetchOpsAheadSkipsBatchWhenPoolIsBehind) {
+    NamespaceString nss("test.t");
+    std::vector<OplogEntry> ops = {
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss, BSON("_id" << 1)),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss, BSON("_id" << 2))};
+
+    // Keep the only pool thread busy, so that everything scheduled after this stays pending.
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    bool started = false;
+    bool released = false;
+    OldThreadPool pool(1);
+    pool.schedule([&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        started = true;
+        cv.notify_all();
+        cv.wait(lk, [&] { return released; });
+    });
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return started; });
+    }
+    auto releasePool = [&] {
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            released = true;
+            cv.notify_all();
+        }
+        pool.join();
+    };
+    auto releaseGuard = MakeGuard(releasePool);
+
+    for (int i = 0; i < 3; i++) {
+        pool.schedule([] {});
+    }
+    ASSERT_EQUALS(3U, pool.getStats().numPendingTasks);
+
+    int numPrefetched = 0;
+    auto countPrefetches = [&](const BSONObj&, bool) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        ++numPrefetched;
+    };
+
+    // More tasks are pending than the batch has ops, so it is skipped.
+    prefetchOpsAhead(ops, &pool, countPrefetches);
+    ASSERT_EQUALS(3U, pool.getStats().numPendingTasks);
+
+    // Once the batch is at least as large as the backlog, it is prefetched.
+    ops.push_back(
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss, BSON("_id" << 3)));
+    prefetchOpsAhead(ops, &pool, countPrefetches);
+    ASSERT_EQUALS(6U, pool.getStats().numPendingTasks);
+
+    releaseGuard.Dismiss();
+    releasePool();
+    ASSERT_EQUALS(3, numPrefetched);
+}
+
+TEST_F(SyncTailTest, PrefetchOpsAheadDoesNotWaitForBatchApplication) {
+    NamespaceString nss("test.t");
+    createCollection(_opCtx.get(), nss, {});
+
+    // Hold the lock the applier holds while it applies a batch.
+    auto applierClient = getServiceContext()->makeClient("applier");
+    auto applierOpCtx = applierClient->makeOperationContext();
+    Lock::ParallelBatchWriterMode pbwm(applierOpCtx->lockState());
+
+    std::vector<OplogEntry> ops = {
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss, BSON("_id" << 1))};
+    OldThreadPool pool(1);
+    prefetchOpsAhead(ops, &pool);
+    pool.join();
+}
+
 TEST_F(IdempotencyTest, Geo2dsphereIndexFailedOnUpdate) {
     ASSERT_OK(
         ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_RECOVERING));
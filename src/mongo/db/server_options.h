@@ -78,7 +78,7 @@ struct ServerGlobalParams {
     std::string socket = "/tmp";  // UNIX domain socket directory
     std::string transportLayer;   // --transportLayer (must be either "asio" or "legacy")
 
-    // --serviceExecutor ("adaptive", "synchronous", or "fixedForTesting")
+    // --serviceExecutor ("adaptive", "workStealing", "synchronous", or "fixedForTesting")
     std::string serviceExecutor;
 
     int maxConns = DEFAULT_MAX_CONN;  // Maximum number of simultaneous open connections.
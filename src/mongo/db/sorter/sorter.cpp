@@ -50,6 +50,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <snappy.h>
 #include <vector>
+#include <zlib.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
@@ -59,8 +60,13 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/unowned_ptr.h"
@@ -102,6 +108,20 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+/**
+ * Precedes each block in a spill file. See SortedFileWriter for the file format.
+ */
+struct BlockHeader {
+    int32_t diskSize;          // Size of the block as written, following this header.
+    int32_t uncompressedSize;  // Size of the serialized data once decrypted and uncompressed.
+    uint32_t checksum;         // CRC-32 of the block as written.
+    uint32_t compressor;       // The SorterFileCompressor the block was compressed with.
+};
+
+inline uint32_t blockChecksum(const char* data, size_t size) {
+    return ::crc32(::crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data), size);
+}
+
 /** Ensures a named file is deleted when this object goes out of scope */
 class FileDeleter {
 public:
@@ -195,19 +215,26 @@ private:
     }
 
     void fill() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
+        BlockHeader header;
+        read(&header, sizeof(header));
         if (_done)
             return;
 
-        // negative size means compressed
-        const bool compressed = rawSize < 0;
-        int32_t blockSize = std::abs(rawSize);
+        int32_t blockSize = header.diskSize;
+        massert(40590,
+                str::stream() << "invalid block size " << blockSize << " in file \"" << _fileName
+                              << "\"",
+                blockSize > 0 && header.uncompressedSize > 0);
 
         _buffer.reset(new char[blockSize]);
         read(_buffer.get(), blockSize);
         massert(16816, "file too short?", !_done);
 
+        massert(40591,
+                str::stream() << "checksum mismatch reading file \"" << _fileName
+                              << "\", the external sort's temporary data is corrupt",
+                blockChecksum(_buffer.get(), blockSize) == header.checksum);
+
         auto encryptionHooks = EncryptionHooks::get(getGlobalServiceContext());
         if (encryptionHooks->enabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
@@ -225,22 +252,54 @@ private:
             _buffer.swap(out);
         }
 
-        if (!compressed) {
-            _reader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
-        }
+        const size_t uncompressedSize = header.uncompressedSize;
+        std::unique_ptr<char[]> decompressionBuffer;
+        switch (static_cast<SorterFileCompressor>(header.compressor)) {
+            case SorterFileCompressor::kNone:
+                massert(40592,
+                        "uncompressed block has the wrong size",
+                        blockSize == header.uncompressedSize);
+                _reader.reset(new BufReader(_buffer.get(), blockSize));
+                return;
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+            case SorterFileCompressor::kSnappy: {
+                dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
 
-        size_t uncompressedSize;
-        massert(17061,
-                "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                size_t snappySize;
+                massert(17061,
+                        "couldn't get uncompressed length",
+                        snappy::GetUncompressedLength(_buffer.get(), blockSize, &snappySize) &&
+                            snappySize == uncompressedSize);
 
-        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
-        massert(17062,
-                "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                decompressionBuffer.reset(new char[uncompressedSize]);
+                massert(17062,
+                        "decompression failed",
+                        snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                break;
+            }
+
+            case SorterFileCompressor::kZlib: {
+                decompressionBuffer.reset(new char[uncompressedSize]);
+                uLongf zlibSize = uncompressedSize;
+                const int ret =
+                    ::uncompress(reinterpret_cast<Bytef*>(decompressionBuffer.get()),
+                                 &zlibSize,
+                                 reinterpret_cast<const Bytef*>(_buffer.get()),
+                                 blockSize);
+                massert(40593,
+                        str::stream() << "zlib decompression failed with error " << ret,
+                        ret == Z_OK && zlibSize == uncompressedSize);
+                break;
+            }
+
+            default:
+                msgasserted(40594,
+                            str::stream() << "unknown compressor "
+                                          << static_cast<int>(header.compressor)
+                                          << " in file \""
+                                          << _fileName
+                                          << "\"");
+        }
 
         // hold on to decompressed data and throw out compressed data at block exit
         _buffer.swap(decompressionBuffer);
@@ -396,6 +455,170 @@ private:
     STLComparator _greater;                      // named so calls make sense
 };
 
+/**
+ * Sorts and writes runs of data to files on a pool of worker threads, so that the thread adding
+ * data to a Sorter only has to wait for a run to be spilled when all of the workers are busy.
+ *
+ * Runs are kept in the order they were handed to spill(), so that merging them remains stable.
+ */
+template <typename Key, typename Value, typename Comparator>
+class ParallelSpiller {
+    MONGO_DISALLOW_COPYING(ParallelSpiller);
+
+public:
+    typedef std::pair<Key, Value> Data;
+    typedef SortIteratorInterface<Key, Value> Iterator;
+    typedef std::pair<typename Key::SorterDeserializeSettings,
+                      typename Value::SorterDeserializeSettings>
+        Settings;
+
+    // Merging fewer runs than this is cheap enough that it is left entirely to the final merge.
+    static const size_t kMinRunsForParallelMerge = 64;
+
+    ParallelSpiller(const SortOptions& opts, const Comparator& comp, const Settings& settings)
+        : _opts(opts), _comp(comp), _settings(settings), _pool([&] {
+              ThreadPool::Options options;
+              options.threadNamePrefix = "ExternalSortWorker-";
+              options.minThreads = 0;
+              options.maxThreads = opts.numWorkerThreads;
+              return options;
+          }()) {
+        invariant(_opts.numWorkerThreads > 1);
+        _pool.startup();
+    }
+
+    ~ParallelSpiller() {
+        // The scheduled tasks refer to this object, so they must all finish before it goes away.
+        _pool.shutdown();
+        _pool.join();
+    }
+
+    /**
+     * Hands 'run' to a worker to be sorted and written to a file. Blocks while every worker is
+     * busy, and rethrows any error encountered by a worker.
+     */
+    void spill(std::shared_ptr<std::deque<Data>> run) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _inFlight < _opts.numWorkerThreads - 1 || _error; });
+        _rethrowIfFailed_inlock();
+
+        const size_t runNum = _iters.size();
+        _iters.emplace_back();
+        _inFlight++;
+        lk.unlock();
+
+        _schedule(runNum, [this, run]() -> Iterator* {
+            std::stable_sort(run->begin(), run->end(), [this](const Data& lhs, const Data& rhs) {
+                dassertCompIsSane(_comp, lhs, rhs);
+                return _comp(lhs, rhs) < 0;
+            });
+
+            SortedFileWriter<Key, Value> writer(_opts, _settings);
+            for (; !run->empty(); run->pop_front()) {
+                writer.addAlreadySorted(run->front().first, run->front().second);
+            }
+            return writer.done();
+        });
+    }
+
+    /**
+     * Waits for every run to be written and returns iterators over them in the order they were
+     * spilled. When there are many runs, contiguous groups of them are first merged into larger
+     * runs concurrently, which leaves far fewer files for the caller's final merge.
+     */
+    std::vector<std::shared_ptr<Iterator>> finish() {
+        _waitForAll();
+
+        if (_iters.size() >= kMinRunsForParallelMerge) {
+            std::vector<std::shared_ptr<Iterator>> runs;
+            runs.swap(_iters);
+
+            // Merging contiguous groups keeps the result stable, since earlier groups hold only
+            // earlier runs.
+            const size_t numGroups = std::min(_opts.numWorkerThreads, runs.size() / 2);
+            for (size_t group = 0; group < numGroups; group++) {
+                auto groupRuns = std::make_shared<std::vector<std::shared_ptr<Iterator>>>(
+                    runs.begin() + (runs.size() * group / numGroups),
+                    runs.begin() + (runs.size() * (group + 1) / numGroups));
+
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _iters.emplace_back();
+                _inFlight++;
+                lk.unlock();
+
+                _schedule(group, [this, groupRuns]() -> Iterator* {
+                    std::unique_ptr<Iterator> merged(Iterator::merge(*groupRuns, _opts, _comp));
+                    SortedFileWriter<Key, Value> writer(_opts, _settings);
+                    while (merged->more()) {
+                        auto next = merged->next();
+                        writer.addAlreadySorted(next.first, next.second);
+                    }
+                    return writer.done();
+                });
+            }
+
+            _waitForAll();
+        }
+
+        return std::move(_iters);
+    }
+
+private:
+    void _schedule(size_t runNum, stdx::function<Iterator*()> task) {
+        auto status = _pool.schedule([this, runNum, task] {
+            std::shared_ptr<Iterator> iter;
+            std::exception_ptr error;
+            try {
+                iter.reset(task());
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _iters[runNum] = std::move(iter);
+            if (error && !_error) {
+                _error = error;
+            }
+            _inFlight--;
+            _cv.notify_all();
+        });
+
+        if (!status.isOK()) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _inFlight--;
+            uassertStatusOK(status);
+        }
+    }
+
+    void _waitForAll() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _inFlight == 0; });
+        _rethrowIfFailed_inlock();
+    }
+
+    void _rethrowIfFailed_inlock() {
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+    const SortOptions _opts;
+    const Comparator _comp;
+    const Settings _settings;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    size_t _inFlight = 0;                           // Runs being sorted, written or merged.
+    std::exception_ptr _error;                      // The first error hit by a worker.
+    std::vector<std::shared_ptr<Iterator>> _iters;  // Spilled runs, by the order they were added.
+
+    // Must be last so that it is shut down before the members its tasks use are destroyed.
+    ThreadPool _pool;
+};
+
+template <typename Key, typename Value, typename Comparator>
+const size_t ParallelSpiller<Key, Value, Comparator>::kMinRunsForParallelMerge;
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -408,8 +631,17 @@ public:
     NoLimitSorter(const SortOptions& opts,
                   const Comparator& comp,
                   const Settings& settings = Settings())
-        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
+        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0), _numSpills(0) {
         verify(_opts.limit == 0);
+
+        _maxRunBytes = _opts.maxMemoryUsageBytes;
+        if (_opts.numWorkerThreads > 1 && _opts.extSortAllowed) {
+            // Each worker may hold a run while the current one is filled, so split the memory
+            // budget between them.
+            _spiller = stdx::make_unique<ParallelSpiller<Key, Value, Comparator>>(
+                _opts, _comp, _settings);
+            _maxRunBytes = _opts.maxMemoryUsageBytes / _opts.numWorkerThreads;
+        }
     }
 
     void add(const Key& key, const Value& val) {
@@ -418,23 +650,26 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > _maxRunBytes)
             spill();
     }
 
     Iterator* done() {
-        if (_iters.empty()) {
+        if (_numSpills == 0) {
             sort();
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        if (_spiller) {
+            _iters = _spiller->finish();
+        }
         return Iterator::merge(_iters, _opts, _comp);
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
-        return _iters.size();
+        return _numSpills;
     }
     size_t memUsed() const {
         return _memUsed;
@@ -479,6 +714,16 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
+        _numSpills++;
+        _memUsed = 0;
+
+        if (_spiller) {
+            auto run = std::make_shared<std::deque<Data>>();
+            run->swap(_data);
+            _spiller->spill(std::move(run));
+            return;
+        }
+
         sort();
 
         SortedFileWriter<Key, Value> writer(_opts, _settings);
@@ -487,16 +732,20 @@ private:
         }
 
         _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
-
-        _memUsed = 0;
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    size_t _maxRunBytes;  // spill once the current data uses more than this
+    size_t _numSpills;
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+
+    // Only set if runs are spilled by worker threads. In that case the spilled runs are held by
+    // the spiller until done() is called.
+    std::unique_ptr<ParallelSpiller<Key, Value, Comparator>> _spiller;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -806,7 +1055,7 @@ inline unsigned nextFileNumber() {
 
 template <typename Key, typename Value>
 SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Settings& settings)
-    : _settings(settings) {
+    : _settings(settings), _compressor(opts.compressor) {
     namespace str = mongoutils::str;
 
     // This should be checked by consumers, but if we get here don't allow writes.
@@ -856,14 +1105,41 @@ void SortedFileWriter<Key, Value>::spill() {
     if (size == 0)
         return;
 
+    sorter::BlockHeader header;
+    header.uncompressedSize = size;
+    header.compressor = static_cast<uint32_t>(SorterFileCompressor::kNone);
+
     std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
+    switch (_compressor) {
+        case SorterFileCompressor::kNone:
+            break;
+
+        case SorterFileCompressor::kSnappy:
+            snappy::Compress(outBuffer, size, &compressed);
+            break;
+
+        case SorterFileCompressor::kZlib: {
+            uLongf zlibSize = ::compressBound(size);
+            compressed.resize(zlibSize);
+            const int ret = ::compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                                        &zlibSize,
+                                        reinterpret_cast<const Bytef*>(outBuffer),
+                                        size,
+                                        Z_BEST_SPEED);
+            massert(40595,
+                    str::stream() << "zlib compression failed with error " << ret,
+                    ret == Z_OK);
+            compressed.resize(zlibSize);
+            break;
+        }
+    }
     verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
-    if (shouldCompress) {
+    // Only keep the compressed block if it saves at least 10%.
+    if (!compressed.empty() && compressed.size() < size_t(_buffer.len() / 10 * 9)) {
         size = compressed.size();
         outBuffer = const_cast<char*>(compressed.data());
+        header.compressor = static_cast<uint32_t>(_compressor);
     }
 
     std::unique_ptr<char[]> out;
@@ -884,11 +1160,11 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // negative size means compressed
-    size = shouldCompress ? -size : size;
+    header.diskSize = size;
+    header.checksum = sorter::blockChecksum(outBuffer, size);
     try {
-        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        _file.write(outBuffer, std::abs(size));
+        _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        _file.write(outBuffer, size);
 
     } catch (const std::exception&) {
         msgasserted(16821,
@@ -36,7 +36,10 @@
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/util/mongoutils/str.h"
 
 /**
  * This is the public API for the Sorter (both in-memory and external)
@@ -89,6 +92,27 @@ namespace sorter {
 class FileDeleter;
 }
 
+/**
+ * How the blocks of a spill file are compressed. A block that does not compress well enough is
+ * stored uncompressed regardless.
+ */
+enum class SorterFileCompressor : uint8_t { kNone = 0, kSnappy = 1, kZlib = 2 };
+
+/**
+ * Parses "none", "snappy" or "zlib" into a SorterFileCompressor.
+ */
+inline StatusWith<SorterFileCompressor> parseSorterFileCompressor(StringData name) {
+    if (name == "none")
+        return SorterFileCompressor::kNone;
+    if (name == "snappy")
+        return SorterFileCompressor::kSnappy;
+    if (name == "zlib")
+        return SorterFileCompressor::kZlib;
+    return {ErrorCodes::BadValue,
+            str::stream() << "unknown spill file compressor '" << name
+                          << "', expected one of 'none', 'snappy' or 'zlib'"};
+}
+
 /**
  * Runtime options that control the Sorter's behavior
  */
@@ -98,8 +122,18 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
-
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    size_t numWorkerThreads;     /// If greater than 1 and there is no limit, full runs are
+                                 /// sorted and spilled, and large merges are split up, by a
+                                 /// pool of this many threads. maxMemoryUsageBytes still bounds
+                                 /// the data held by the Sorter and its workers combined.
+    SorterFileCompressor compressor;  /// How to compress the blocks of spilled runs.
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          numWorkerThreads(1),
+          compressor(SorterFileCompressor::kSnappy) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -122,6 +156,16 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& NumWorkerThreads(size_t newNumWorkerThreads) {
+        numWorkerThreads = newNumWorkerThreads;
+        return *this;
+    }
+
+    SortOptions& Compressor(SorterFileCompressor newCompressor) {
+        compressor = newCompressor;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -180,7 +224,14 @@ protected:
     Sorter() {}  // can only be constructed as a base
 };
 
-/// Writes pre-sorted data to a sorted file and hands-back an Iterator over that file.
+/**
+ * Writes pre-sorted data to a sorted file and hands-back an Iterator over that file.
+ *
+ * The file is a sequence of blocks, each made up of a header followed by up to about 64KB of
+ * serialized data, compressed with SortOptions::compressor if that saves enough space and then
+ * protected by the EncryptionHooks if they are enabled. The header records how the block was
+ * compressed and a checksum of the block as written, which is verified when it is read back.
+ */
 template <typename Key, typename Value>
 class SortedFileWriter {
     MONGO_DISALLOW_COPYING(SortedFileWriter);
@@ -200,6 +251,7 @@ private:
     void spill();
 
     const Settings _settings;
+    const SorterFileCompressor _compressor;
     std::string _fileName;
     std::shared_ptr<sorter::FileDeleter> _fileDeleter;  // Must outlive _file
     std::ofstream _file;
@@ -218,6 +270,7 @@ private:
     template class ::mongo::SortedFileWriter<Key, Value>;                                \
     /* internal classes */                                                               \
     template class ::mongo::sorter::NoLimitSorter<Key, Value, Comparator>;               \
+    template class ::mongo::sorter::ParallelSpiller<Key, Value, Comparator>;             \
     template class ::mongo::sorter::LimitOneSorter<Key, Value, Comparator>;              \
     template class ::mongo::sorter::TopKSorter<Key, Value, Comparator>;                  \
     template class ::mongo::sorter::MergeIterator<Key, Value, Comparator>;               \
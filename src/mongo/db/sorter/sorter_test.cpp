@@ -31,6 +31,7 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem.hpp>
+#include <fstream>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/init.h"
@@ -271,6 +272,35 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
                                         make_shared<IntIterator>(0, 10 * 1000 * 1000));
         }
+        for (auto compressor : {SorterFileCompressor::kNone,
+                                SorterFileCompressor::kSnappy,
+                                SorterFileCompressor::kZlib}) {  // each compressor
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(
+                SortOptions(opts).Compressor(compressor));
+            for (int i = 0; i < 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        make_shared<IntIterator>(0, 1000 * 1000));
+        }
+        {  // corrupt
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+            for (int i = 0; i < 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+            std::shared_ptr<IWIterator> iter(sorter.done());
+
+            // Flip a bit in the last byte of the only block, which is covered by its checksum.
+            boost::filesystem::directory_iterator file(tempDir.path());
+            std::fstream stream(file->path().string(),
+                                std::ios::in | std::ios::out | std::ios::binary);
+            stream.seekg(-1, std::ios::end);
+            const char last = stream.get();
+            stream.seekp(-1, std::ios::end);
+            stream.put(last ^ 1);
+            stream.close();
+
+            ASSERT_THROWS_CODE(iter->more(), DBException, 40591);
+        }
 
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
@@ -541,6 +571,30 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+template <bool Random = true>
+class LotsOfDataLittleMemoryParallelSpills : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    typedef ParallelSpiller<IntWrapper, IntWrapper, IWComparator> Spiller;
+
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).NumWorkerThreads(NUM_WORKER_THREADS);
+    }
+
+    void addData(unowned_ptr<IWSorter> sorter) {
+        Parent::addData(sorter);
+
+        // Each run gets a share of the memory limit, and there should be enough of them to be
+        // merged in groups by the workers before the final merge.
+        ASSERT_GREATER_THAN_OR_EQUALS(
+            static_cast<size_t>(sorter->numFiles()),
+            (Parent::NUM_ITEMS * sizeof(IWPair)) / (Parent::MEM_LIMIT / NUM_WORKER_THREADS));
+        ASSERT_GREATER_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()),
+                                      Spiller::kMinRunsForParallelMerge);
+    }
+
+    enum { NUM_WORKER_THREADS = 4 };
+};
 }
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -562,6 +616,8 @@ public:
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/true>>();    // fits in mem
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/false>>();  // spills
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/true>>();   // spills
+        add<SorterTests::LotsOfDataLittleMemoryParallelSpills</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallelSpills</*random=*/true>>();
     }
 };
 
@@ -522,6 +522,26 @@ TEST_F(KeyStringTest, Timestamp) {
     }
 }
 
+TEST_F(KeyStringTest, LongStringsAroundVectorBoundaries) {
+    // Exercise both the vectorized and the byte-at-a-time paths used to invert descending keys.
+    for (size_t len = 0; len <= 70; len++) {
+        std::string str;
+        for (size_t i = 0; i < len; i++)
+            str.push_back(static_cast<char>('a' + (i % 26)));
+        ROUNDTRIP(version, BSON("" << str));
+        ROUNDTRIP(version, BSON("" << BSONSymbol(str)));
+        ROUNDTRIP(version, BSON("" << BSONBinData(str.data(), len, BinDataGeneral)));
+        ROUNDTRIP(version, BSON(str << 1));
+
+        // Embedded NUL bytes are re-encoded as "\x00\xff" and must survive inversion.
+        if (len > 0) {
+            str[len / 2] = '\0';
+            ROUNDTRIP(version, BSON("" << str));
+            ROUNDTRIP(version, BSON("" << BSONCode(str)));
+        }
+    }
+}
+
 TEST_F(KeyStringTest, AllTypesRoundtrip) {
     for (int i = 1; i <= JSTypeMax; i++) {
         {
@@ -1106,9 +1126,12 @@ unsigned newSeed() {
 
 /**
  * Evaluates ROUNDTRIP on all items in Numbers a sufficient number of times to take at least
- * kMinPerfMicros microseconds. Logs the elapsed time per ROUNDTRIP evaluation.
+ * kMinPerfMicros microseconds, using the given ordering. Logs the elapsed time per ROUNDTRIP
+ * evaluation.
  */
-void perfTest(KeyString::Version version, const Numbers& numbers) {
+void perfTest(KeyString::Version version,
+              const Numbers& numbers,
+              Ordering ordering = ALL_ASCENDING) {
     uint64_t micros = 0;
     uint64_t iters;
     // Ensure at least 16 iterations are done and at least 50 milliseconds is timed
@@ -1120,8 +1143,8 @@ void perfTest(KeyString::Version version, const Numbers& numbers) {
             for (auto item : numbers) {
                 // Assuming there are sufficient invariants in the to/from KeyString methods
                 // that calls will not be optimized away.
-                const KeyString ks(version, item, ALL_ASCENDING);
-                const BSONObj& converted = toBson(ks, ALL_ASCENDING);
+                const KeyString ks(version, item, ordering);
+                const BSONObj& converted = toBson(ks, ordering);
                 invariant(converted.binaryEqual(item));
             }
 
@@ -1251,3 +1274,33 @@ TEST_F(KeyStringTest, DecimalFromUniformDoublePerf) {
     }
     perfTest(version, numbers);
 }
+
+TEST_F(KeyStringTest, DescendingStringPerf) {
+    std::mt19937 gen(newSeed());
+    std::uniform_int_distribution<int> length(16, 256);
+    std::uniform_int_distribution<int> letter('a', 'z');
+
+    std::vector<BSONObj> strings;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        std::string str(length(gen), '\0');
+        for (auto& c : str)
+            c = static_cast<char>(letter(gen));
+        strings.push_back(BSON("" << str));
+    }
+    perfTest(version, strings, ONE_DESCENDING);
+}
+
+TEST_F(KeyStringTest, DescendingBinDataPerf) {
+    std::mt19937 gen(newSeed());
+    std::uniform_int_distribution<int> length(16, 256);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    std::vector<BSONObj> blobs;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        std::string data(length(gen), '\0');
+        for (auto& c : data)
+            c = static_cast<char>(byte(gen));
+        blobs.push_back(BSON("" << BSONBinData(data.data(), data.size(), BinDataGeneral)));
+    }
+    perfTest(version, blobs, ONE_DESCENDING);
+}
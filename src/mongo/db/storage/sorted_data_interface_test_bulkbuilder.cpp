@@ -199,5 +199,36 @@ TEST(SortedDataInterface, BuilderAddMultipleCompoundKeys) {
     }
 }
 
+// Add many compound keys sharing a long prefix using a bulk builder, and read them back in order.
+TEST(SortedDataInterface, BuilderAddManyCompoundKeysWithSharedPrefix) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+
+    const std::string tenant(200, 't');
+    const int nToInsert = 10000;
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        const std::unique_ptr<SortedDataBuilderInterface> builder(
+            sorted->getBulkBuilder(opCtx.get(), true));
+
+        for (int i = 0; i < nToInsert; i++) {
+            ASSERT_OK(builder->addKey(BSON("" << tenant << "" << i), RecordId(42, i * 2)));
+        }
+        builder->commit(false);
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert, sorted->numEntries(opCtx.get()));
+
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        for (int i = 0; i < nToInsert; i++) {
+            auto entry = i == 0 ? cursor->seek(kMinBSONKey, true) : cursor->next();
+            ASSERT_EQ(entry, IndexKeyEntry(BSON("" << tenant << "" << i), RecordId(42, i * 2)));
+        }
+        ASSERT(!cursor->next());
+    }
+}
+
 }  // namespace
 }  // namespace mongo
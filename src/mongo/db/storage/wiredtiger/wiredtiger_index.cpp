@@ -579,7 +579,7 @@ protected:
 class WiredTigerIndex::StandardBulkBuilder : public BulkBuilder {
 public:
     StandardBulkBuilder(WiredTigerIndex* idx, OperationContext* opCtx, KVPrefix prefix)
-        : BulkBuilder(idx, opCtx, prefix), _idx(idx) {}
+        : BulkBuilder(idx, opCtx, prefix), _idx(idx), _keyString(idx->keyStringVersion()) {}
 
     Status addKey(const BSONObj& key, const RecordId& id) {
         {
@@ -588,15 +588,16 @@ public:
                 return s;
         }
 
-        KeyString data(_idx->keyStringVersion(), key, _idx->_ordering, id);
+        _keyString.resetToKey(key, _idx->_ordering, id);
 
         // Can't use WiredTigerCursor since we aren't using the cache.
-        WiredTigerItem item(data.getBuffer(), data.getSize());
+        WiredTigerItem item(_keyString.getBuffer(), _keyString.getSize());
         setKey(_cursor, item.Get());
 
-        WiredTigerItem valueItem = data.getTypeBits().isAllZeros()
+        const KeyString::TypeBits& typeBits = _keyString.getTypeBits();
+        WiredTigerItem valueItem = typeBits.isAllZeros()
             ? emptyItem
-            : WiredTigerItem(data.getTypeBits().getBuffer(), data.getTypeBits().getSize());
+            : WiredTigerItem(typeBits.getBuffer(), typeBits.getSize());
 
         _cursor->set_value(_cursor, valueItem.Get());
 
@@ -614,6 +615,7 @@ public:
 
 private:
     WiredTigerIndex* _idx;
+    KeyString _keyString;
 };
 
 /**
@@ -633,7 +635,8 @@ public:
         : BulkBuilder(idx, opCtx, prefix),
           _idx(idx),
           _dupsAllowed(dupsAllowed),
-          _keyString(idx->keyStringVersion()) {}
+          _keyString(idx->keyStringVersion()),
+          _value(idx->keyStringVersion()) {}
 
     Status addKey(const BSONObj& newKey, const RecordId& id) {
         {
@@ -681,18 +684,18 @@ private:
     void doInsert() {
         invariant(!_records.empty());
 
-        KeyString value(_idx->keyStringVersion());
+        _value.resetToEmpty();
         for (size_t i = 0; i < _records.size(); i++) {
-            value.appendRecordId(_records[i].first);
+            _value.appendRecordId(_records[i].first);
             // When there is only one record, we can omit AllZeros TypeBits. Otherwise they need
             // to be included.
             if (!(_records[i].second.isAllZeros() && _records.size() == 1)) {
-                value.appendTypeBits(_records[i].second);
+                _value.appendTypeBits(_records[i].second);
             }
         }
 
         WiredTigerItem keyItem(_keyString.getBuffer(), _keyString.getSize());
-        WiredTigerItem valueItem(value.getBuffer(), value.getSize());
+        WiredTigerItem valueItem(_value.getBuffer(), _value.getSize());
 
         setKey(_cursor, keyItem.Get());
         _cursor->set_value(_cursor, valueItem.Get());
@@ -706,6 +709,7 @@ private:
     const bool _dupsAllowed;
     BSONObj _key;
     KeyString _keyString;
+    KeyString _value;
     std::vector<std::pair<RecordId, KeyString::TypeBits>> _records;
 };
 
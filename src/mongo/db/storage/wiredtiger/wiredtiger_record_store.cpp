@@ -62,6 +62,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 //#define RS_ITERATOR_TRACE(x) log() << "WTRS::Iterator " << x
 #define RS_ITERATOR_TRACE(x)
@@ -137,6 +138,7 @@ public:
 
         stdx::lock_guard<stdx::mutex> lk(_oplogStones->_mutex);
         _oplogStones->_stones.clear();
+        _oplogStones->_persistStones_inlock();
     }
 
     void rollback() final {}
@@ -147,8 +149,6 @@ private:
 
 WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* opCtx, WiredTigerRecordStore* rs)
     : _rs(rs) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
     invariant(rs->isCapped());
     invariant(rs->cappedMaxSize() > 0);
     unsigned long long maxSize = rs->cappedMaxSize();
@@ -161,7 +161,12 @@ WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* opCtx, WiredTi
     _minBytesPerStone = maxSize / numStonesToKeep;
     invariant(_minBytesPerStone > 0);
 
+    // Nothing else can see the stones yet, but _persistStones_inlock() requires '_mutex'.
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Timer timer;
     _calculateStones(opCtx, numStonesToKeep);
+    _totalTimeProcessing = Microseconds(timer.micros());
+    _persistStones_inlock();
     _pokeReclaimThreadIfNeeded();  // Reclaim stones if over the limit.
 }
 
@@ -207,6 +212,7 @@ WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
 void WiredTigerRecordStore::OplogStones::popOldestStone() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     _stones.pop_front();
+    _persistStones_inlock();
 }
 
 void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRecord) {
@@ -232,6 +238,7 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
     LOG(2) << "create new oplogStone, current stones:" << _stones.size();
     OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
     _stones.push_back(stone);
+    _persistStones_inlock();
 
     _pokeReclaimThreadIfNeeded();
 }
@@ -276,6 +283,10 @@ void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
     // being filled.
     _currentRecords.addAndFetch(recordsInStonesToRemove - recordsRemoved);
     _currentBytes.addAndFetch(bytesInStonesToRemove - bytesRemoved);
+
+    if (numStonesToRemove > 0) {
+        _persistStones_inlock();
+    }
 }
 
 void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
@@ -296,6 +307,12 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     log() << "The size storer reports that the oplog contains " << numRecords
           << " records totaling to " << dataSize << " bytes";
 
+    // Reuse the stones saved before the last shutdown, which avoids scanning or sampling what may
+    // be a very large oplog.
+    if (_loadPersistedStones(opCtx)) {
+        return;
+    }
+
     // Only use sampling to estimate where to place the oplog stones if the number of samples drawn
     // is less than 5% of the collection.
     const uint64_t kMinSampleRatioForRandCursor = 20;
@@ -320,6 +337,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
 
 void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* opCtx) {
     log() << "Scanning the oplog to determine where to place markers for truncation";
+    _processingMethod = "scanning";
 
     long long numRecords = 0;
     long long dataSize = 0;
@@ -424,6 +442,90 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
     // Account for the partially filled chunk.
     _currentRecords.store(_rs->numRecords(opCtx) - estRecordsPerStone * wholeStones);
     _currentBytes.store(_rs->dataSize(opCtx) - estBytesPerStone * wholeStones);
+    _processingMethod = "sampling";
+}
+
+bool WiredTigerRecordStore::OplogStones::_loadPersistedStones(OperationContext* opCtx) {
+    if (!_rs->_sizeStorer) {
+        return false;
+    }
+
+    BSONObj persisted = _rs->_sizeStorer->loadOplogStonesFromCache(_rs->getURI());
+    if (persisted.isEmpty()) {
+        return false;
+    }
+
+    RecordId earliestRecord;
+    RecordId latestRecord;
+    {
+        auto record = _rs->getCursor(opCtx, /*forward=*/true)->next();
+        if (!record) {
+            return false;
+        }
+        earliestRecord = record->id;
+    }
+    {
+        auto record = _rs->getCursor(opCtx, /*forward=*/false)->next();
+        if (!record) {
+            return false;
+        }
+        latestRecord = record->id;
+    }
+
+    // The stones are saved lazily, so they may still include stones which have since been
+    // truncated, or be missing the newest ones. Anything else means they don't describe this oplog.
+    std::deque<OplogStones::Stone> stones;
+    int64_t recordsInStones = 0;
+    int64_t bytesInStones = 0;
+    for (auto&& elem : persisted) {
+        if (elem.type() != Object) {
+            return false;
+        }
+        BSONObj obj = elem.Obj();
+        OplogStones::Stone stone = {obj["records"].safeNumberLong(),
+                                    obj["bytes"].safeNumberLong(),
+                                    RecordId(obj["lastRecord"].safeNumberLong())};
+        if (stone.records <= 0 || stone.bytes <= 0 || !stone.lastRecord.isNormal() ||
+            stone.lastRecord > latestRecord ||
+            (!stones.empty() && stone.lastRecord <= stones.back().lastRecord)) {
+            log() << "Ignoring the saved oplog truncation markers as they do not match the oplog";
+            return false;
+        }
+        if (stone.lastRecord < earliestRecord) {
+            continue;
+        }
+        stones.push_back(stone);
+        recordsInStones += stone.records;
+        bytesInStones += stone.bytes;
+    }
+
+    if (stones.empty()) {
+        return false;
+    }
+
+    log() << "Loaded " << stones.size() << " saved oplog truncation markers, the newest at optime "
+          << Timestamp(stones.back().lastRecord.repr()).toStringPretty();
+
+    _stones.swap(stones);
+    _currentRecords.store(std::max<int64_t>(0, _rs->numRecords(opCtx) - recordsInStones));
+    _currentBytes.store(std::max<int64_t>(0, _rs->dataSize(opCtx) - bytesInStones));
+    _processingMethod = "persisted";
+    return true;
+}
+
+void WiredTigerRecordStore::OplogStones::_persistStones_inlock() {
+    if (!_rs->_sizeStorer) {
+        return;
+    }
+
+    BSONArrayBuilder builder;
+    for (auto&& stone : _stones) {
+        builder.append(BSON("records" << static_cast<long long>(stone.records) << "bytes"
+                                      << static_cast<long long>(stone.bytes)
+                                      << "lastRecord"
+                                      << static_cast<long long>(stone.lastRecord.repr())));
+    }
+    _rs->_sizeStorer->storeOplogStonesToCache(_rs->getURI(), builder.arr());
 }
 
 void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded() {
@@ -444,6 +546,27 @@ void WiredTigerRecordStore::OplogStones::adjust(int64_t maxSize) {
     _pokeReclaimThreadIfNeeded();
 }
 
+void WiredTigerRecordStore::OplogStones::recordTruncation(Microseconds elapsed) {
+    _truncateCount.addAndFetch(1);
+    _totalTimeTruncatingMicros.addAndFetch(durationCount<Microseconds>(elapsed));
+}
+
+void WiredTigerRecordStore::OplogStones::appendStats(OperationContext* opCtx,
+                                                     BSONObjBuilder* builder) const {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        builder->append("numStones", static_cast<long long>(_stones.size()));
+    }
+    // The amount by which the oplog exceeds its maximum size while waiting to be truncated.
+    const int64_t excessBytes = std::max<int64_t>(0, _rs->dataSize(opCtx) - _rs->cappedMaxSize());
+    builder->append("excessBytes", static_cast<long long>(excessBytes));
+    builder->append("processingMethod", _processingMethod);
+    builder->append("totalTimeProcessingMicros", durationCount<Microseconds>(_totalTimeProcessing));
+    builder->append("truncateCount", static_cast<long long>(_truncateCount.load()));
+    builder->append("totalTimeTruncatingMicros",
+                    static_cast<long long>(_totalTimeTruncatingMicros.load()));
+}
+
 StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj options) {
     StringBuilder ss;
     BSONForEach(elem, options) {
@@ -1061,6 +1184,7 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
         WT_SESSION* session = ru->getSession(opCtx)->getSession();
 
         try {
+            Timer timer;
             WriteUnitOfWork wuow(opCtx);
 
             WiredTigerCursor startwrap(_uri, _tableId, true, opCtx);
@@ -1079,6 +1203,7 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
 
             // Remove the stone after a successful truncation.
             _oplogStones->popOldestStone();
+            _oplogStones->recordTruncation(Microseconds(timer.micros()));
 
             // Stash the truncate point for next time to cleanly skip over tombstones, etc.
             _oplogStones->firstRecord = stone->lastRecord;
@@ -1460,6 +1585,10 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* opCtx,
         result->appendIntOrLL("sleepCount", _cappedSleep.load());
         result->appendIntOrLL("sleepMS", _cappedSleepMS.load());
     }
+    if (_oplogStones) {
+        BSONObjBuilder oplogTruncation(result->subobjStart("oplogTruncation"));
+        _oplogStones->appendStats(opCtx, &oplogTruncation);
+    }
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx);
     WT_SESSION* s = session->getSession();
     BSONObjBuilder bob(result->subobjStart(_engineName));
@@ -35,9 +35,11 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/duration.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class OperationContext;
 class RecordId;
 
@@ -90,6 +92,12 @@ public:
     // Resize oplog size
     void adjust(int64_t maxSize);
 
+    // Records that the oldest stone was removed by a truncation which took 'elapsed'.
+    void recordTruncation(Microseconds elapsed);
+
+    // Appends metrics about the oplog stones and the truncation of the oplog to 'builder'.
+    void appendStats(OperationContext* opCtx, BSONObjBuilder* builder) const;
+
     // The start point of where to truncate next. Used by the background reclaim thread to
     // efficiently truncate records with WiredTiger by skipping over tombstones, etc.
     RecordId firstRecord;
@@ -123,6 +131,13 @@ private:
                                     int64_t estRecordsPerStone,
                                     int64_t estBytesPerStone);
 
+    // Restores the stones saved in the size storer by _persistStones_inlock(). Returns false,
+    // leaving the stones untouched, if there are none or they don't match the oplog's contents.
+    bool _loadPersistedStones(OperationContext* opCtx);
+
+    // Saves the current stones in the size storer, which writes them to disk with the next sync.
+    void _persistStones_inlock();
+
     void _pokeReclaimThreadIfNeeded();
 
     static const uint64_t kRandomSamplesPerStone = 10;
@@ -145,6 +160,13 @@ private:
 
     mutable stdx::mutex _mutex;  // Protects against concurrent access to the deque of oplog stones.
     std::deque<OplogStones::Stone> _stones;  // front = oldest, back = newest.
+
+    // How the stones were determined at startup, and how long it took. Set by the constructor.
+    std::string _processingMethod;
+    Microseconds _totalTimeProcessing;
+
+    AtomicInt64 _truncateCount;              // Number of stones removed from the oplog.
+    AtomicInt64 _totalTimeTruncatingMicros;  // Time spent removing them.
 };
 
 }  // namespace mongo
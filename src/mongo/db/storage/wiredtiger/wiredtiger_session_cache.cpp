@@ -35,24 +35,33 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/current_cpu.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
+namespace {
+// The maximum number of cursors each session keeps open for reuse.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCursorCacheSize, int, 10000);
+}  // namespace
+
 WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, uint64_t epoch, uint64_t cursorEpoch)
     : _epoch(epoch),
       _cursorEpoch(cursorEpoch),
       _session(NULL),
-      _cursorGen(0),
       _cursorsCached(0),
       _cursorsOut(0) {
     invariantWTOK(conn->open_session(conn, NULL, "isolation=snapshot", &_session));
@@ -66,7 +75,6 @@ WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn,
       _cursorEpoch(cursorEpoch),
       _cache(cache),
       _session(NULL),
-      _cursorGen(0),
       _cursorsCached(0),
       _cursorsOut(0) {
     invariantWTOK(conn->open_session(conn, NULL, "isolation=snapshot", &_session));
@@ -79,17 +87,23 @@ WiredTigerSession::~WiredTigerSession() {
 }
 
 WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri, uint64_t id, bool forRecordStore) {
-    // Find the most recently used cursor
-    for (CursorCache::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        if (i->_id == id) {
-            WT_CURSOR* c = i->_cursor;
-            _cursors.erase(i);
-            _cursorsOut++;
-            _cursorsCached--;
-            return c;
-        }
+    auto indexed = _cursorIndex.find(id);
+    if (indexed != _cursorIndex.end()) {
+        // Reuse the most recently released cursor, leaving the older ones to age out.
+        std::deque<CursorCache::iterator>& cached = indexed->second;
+        CursorCache::iterator i = cached.back();
+        WT_CURSOR* c = i->_cursor;
+        cached.pop_back();
+        if (cached.empty())
+            _cursorIndex.erase(indexed);
+        _cursors.erase(i);
+        _cursorsOut++;
+        _cursorsCached--;
+        _cursorCacheHits++;
+        return c;
     }
 
+    _cursorCacheMisses++;
     WT_CURSOR* c = NULL;
     int ret = _session->open_cursor(
         _session, uri.c_str(), NULL, forRecordStore ? "" : "overwrite=false", &c);
@@ -108,33 +122,61 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
     invariantWTOK(cursor->reset(cursor));
 
     // Cursors are pushed to the front of the list and removed from the back
-    _cursors.push_front(WiredTigerCachedCursor(id, _cursorGen++, cursor));
+    _cursors.push_front(WiredTigerCachedCursor(id, cursor));
+    _cursorIndex[id].push_back(_cursors.begin());
     _cursorsCached++;
 
-    // "Old" is defined as not used in the last N**2 operations, if we have N cursors cached.
-    // The reasoning here is to imagine a workload with N tables performing operations randomly
-    // across all of them (i.e., each cursor has 1/N chance of used for each operation).  We
-    // would like to cache N cursors in that case, so any given cursor could go N**2 operations
-    // in between use.
-    while (_cursorGen - _cursors.back()._gen > 10000) {
-        cursor = _cursors.back()._cursor;
-        _cursors.pop_back();
-        _cursorsCached--;
-        invariantWTOK(cursor->close(cursor));
+    // Unlike the number of cursors out, which is bounded by what a single operation needs, the
+    // number of cursors cached grows with the number of tables a session touches over its
+    // lifetime, so only keep the most recently used ones.
+    const int maxCached = std::max(wiredTigerCursorCacheSize.load(), 0);
+    while (_cursorsCached > maxCached) {
+        _evictOldestCursor();
     }
 }
 
+void WiredTigerSession::_evictOldestCursor() {
+    CursorCache::iterator oldest = std::prev(_cursors.end());
+    // The least recently used cursor overall is also the least recently used one for its ID.
+    auto indexed = _cursorIndex.find(oldest->_id);
+    invariant(indexed != _cursorIndex.end() && indexed->second.front() == oldest);
+    indexed->second.pop_front();
+    if (indexed->second.empty())
+        _cursorIndex.erase(indexed);
+
+    WT_CURSOR* cursor = oldest->_cursor;
+    _cursors.erase(oldest);
+    _cursorsCached--;
+    _cursorCacheEvictions++;
+    invariantWTOK(cursor->close(cursor));
+}
+
+void WiredTigerSession::_rebuildCursorIndex() {
+    _cursorIndex.clear();
+    // The cursor cache is most recently used first, so pushing to the front of each ID's entry
+    // leaves it least recently used first.
+    for (auto i = _cursors.begin(); i != _cursors.end(); ++i) {
+        _cursorIndex[i->_id].push_front(i);
+    }
+    _cursorsCached = _cursors.size();
+}
+
 void WiredTigerSession::closeAllCursors(const std::string& uri) {
     invariant(_session);
 
+    bool closedAny = false;
     for (auto i = _cursors.begin(); i != _cursors.end();) {
         WT_CURSOR* cursor = i->_cursor;
         if (cursor && uri == cursor->uri) {
             invariantWTOK(cursor->close(cursor));
             i = _cursors.erase(i);
+            closedAny = true;
         } else
             ++i;
     }
+
+    if (closedAny)
+        _rebuildCursorIndex();
 }
 
 void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
@@ -142,7 +184,10 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
 
     _cursorEpoch = _cache->getCursorEpoch();
     auto toDrop = engine->filterCursorsWithQueuedDrops(&_cursors);
+    if (toDrop.empty())
+        return;
 
+    _rebuildCursorIndex();
     for (auto i = toDrop.begin(); i != toDrop.end(); i++) {
         WT_CURSOR* cursor = i->_cursor;
         if (cursor) {
@@ -269,34 +314,69 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
 }
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
-    }
+    _forEachCachedSession([&uri](WiredTigerSession* session) { session->closeAllCursors(uri); });
 }
 
 void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
-    }
+    _forEachCachedSession(
+        [this](WiredTigerSession* session) { session->closeCursorsForQueuedDrops(_engine); });
 }
 
-void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch.
+void WiredTigerSessionCache::_forEachCachedSession(
+    const stdx::function<void(WiredTigerSession*)>& func) {
     SessionCache swap;
+    for (auto&& partition : _partitions) {
+        {
+            stdx::lock_guard<SpinLock> lock(partition.lock);
+            partition.sessions.swap(swap);
+        }
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            func(*i);
+        }
+
+        {
+            stdx::lock_guard<SpinLock> lock(partition.lock);
+            // If closeAll() ran in the meantime, its sessions must not be cached again.
+            const uint64_t currentEpoch = _epoch.load();
+            auto staleBegin = std::stable_partition(
+                swap.begin(), swap.end(), [currentEpoch](WiredTigerSession* session) {
+                    return session->_getEpoch() == currentEpoch;
+                });
+
+            // Sessions released in the meantime were used more recently, so they stay at the
+            // back, where getSession() takes sessions from.
+            partition.sessions.insert(partition.sessions.begin(), swap.begin(), staleBegin);
+            swap.erase(swap.begin(), staleBegin);
+        }
+
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            delete (*i);
+        }
+        swap.clear();
     }
+}
 
-    for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
-        delete (*i);
+void WiredTigerSessionCache::closeAll() {
+    // Increment the epoch as we are now closing all sessions with this epoch. This happens before
+    // emptying any partition, so a session released concurrently either goes into a partition
+    // which is yet to be emptied, or sees the new epoch under the partition lock and is deleted.
+    _epoch.fetchAndAdd(1);
+
+    SessionCache swap;
+    for (auto&& partition : _partitions) {
+        {
+            stdx::lock_guard<SpinLock> lock(partition.lock);
+            partition.sessions.swap(swap);
+        }
+
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            delete (*i);
+        }
+        swap.clear();
     }
 }
 
@@ -309,13 +389,16 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
+    // Look in the partition of the current CPU first, then in a few of its neighbours.
+    const size_t home = _currentPartition();
+    for (size_t i = 0; i < kMaxPartitionsProbed; i++) {
+        auto& partition = _partitions[(home + i) % kNumPartitions];
+        stdx::lock_guard<SpinLock> lock(partition.lock);
+        if (!partition.sessions.empty()) {
             // Get the most recently used session so that if we discard sessions, we're
             // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+            WiredTigerSession* cachedSession = partition.sessions.back();
+            partition.sessions.pop_back();
             return UniqueWiredTigerSession(cachedSession);
         }
     }
@@ -362,15 +445,20 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
 
     bool returnedToCache = false;
     uint64_t currentEpoch = _epoch.load();
+    auto& partition = _partitions[_currentPartition()];
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        stdx::lock_guard<SpinLock> lock(partition.lock);
+        _collectCursorCacheStats(&partition, session);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            partition.sessions.push_back(session);
         }
-    } else
+    } else {
         invariant(session->_getEpoch() < currentEpoch);
+        stdx::lock_guard<SpinLock> lock(partition.lock);
+        _collectCursorCacheStats(&partition, session);
+    }
 
     if (!returnedToCache)
         delete session;
@@ -379,6 +467,59 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
         _engine->dropSomeQueuedIdents();
 }
 
+// static
+void WiredTigerSessionCache::_collectCursorCacheStats(SessionCachePartition* partition,
+                                                      WiredTigerSession* session) {
+    partition->cursorCacheHits += session->_cursorCacheHits;
+    partition->cursorCacheMisses += session->_cursorCacheMisses;
+    partition->cursorCacheEvictions += session->_cursorCacheEvictions;
+    session->_cursorCacheHits = 0;
+    session->_cursorCacheMisses = 0;
+    session->_cursorCacheEvictions = 0;
+}
+
+void WiredTigerSessionCache::appendCursorCacheStats(BSONObjBuilder* builder) {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<SpinLock> lock(partition.lock);
+        hits += partition.cursorCacheHits;
+        misses += partition.cursorCacheMisses;
+        evictions += partition.cursorCacheEvictions;
+    }
+
+    BSONObjBuilder bob(builder->subobjStart("cursorCache"));
+    bob.append("hits", static_cast<long long>(hits));
+    bob.append("misses", static_cast<long long>(misses));
+    bob.append("evictions", static_cast<long long>(evictions));
+    bob.done();
+}
+
+namespace {
+// Partition to use instead of the CPU's, for tests. Negative if unset.
+thread_local int partitionForTest = -1;
+}  // namespace
+
+// static
+size_t WiredTigerSessionCache::_currentPartition() {
+    if (MONGO_unlikely(partitionForTest >= 0)) {
+        return static_cast<size_t>(partitionForTest) % kNumPartitions;
+    }
+    return currentCPUOrThreadIndex() % kNumPartitions;
+}
+
+// static
+void WiredTigerSessionCache::setPartitionForCurrentThread_forTest(
+    boost::optional<size_t> partition) {
+    partitionForTest = partition ? static_cast<int>(*partition) : -1;
+}
+
+size_t WiredTigerSessionCache::getIdleSessionsCount_forTest(size_t partition) {
+    invariant(partition < kNumPartitions);
+    stdx::lock_guard<SpinLock> lock(_partitions[partition].lock);
+    return _partitions[partition].sessions.size();
+}
 
 void WiredTigerSessionCache::setJournalListener(JournalListener* jl) {
     stdx::unique_lock<stdx::mutex> lk(_journalListenerMutex);
@@ -31,34 +31,39 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <deque>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
 class WiredTigerCachedCursor {
 public:
-    WiredTigerCachedCursor(uint64_t id, uint64_t gen, WT_CURSOR* cursor)
-        : _id(id), _gen(gen), _cursor(cursor) {}
+    WiredTigerCachedCursor(uint64_t id, WT_CURSOR* cursor) : _id(id), _cursor(cursor) {}
 
-    uint64_t _id;   // Source ID, assigned to each URI
-    uint64_t _gen;  // Generation, used to age out old cursors
+    uint64_t _id;  // Source ID, assigned to each URI
     WT_CURSOR* _cursor;
 };
 
 /**
- * This is a structure that caches 1 cursor for each uri.
+ * This is a structure that caches cursors by table id, evicting the least recently used ones once
+ * more than wiredTigerCursorCacheSize cursors are cached.
  * The idea is that there is a pool of these somewhere.
  * NOT THREADSAFE
  */
@@ -114,9 +119,19 @@ public:
 private:
     friend class WiredTigerSessionCache;
 
-    // The cursor cache is a list of pairs that contain an ID and cursor
+    // The cursor cache is a list of pairs that contain an ID and cursor, most recently used first
     typedef std::list<WiredTigerCachedCursor> CursorCache;
 
+    // Finds the cached cursors for an ID without scanning the cursor cache. Each ID's cursors are
+    // kept least recently used first, in the same relative order as in the cursor cache.
+    typedef stdx::unordered_map<uint64_t, std::deque<CursorCache::iterator>> CursorIndex;
+
+    // Closes and removes the least recently used cursor from the cache
+    void _evictOldestCursor();
+
+    // Makes the index match the cursor cache after cursors were removed from it directly
+    void _rebuildCursorIndex();
+
     // Used internally by WiredTigerSessionCache
     uint64_t _getEpoch() const {
         return _epoch;
@@ -132,8 +147,13 @@ private:
     WiredTigerSessionCache* _cache;  // not owned
     WT_SESSION* _session;            // owned
     CursorCache _cursors;            // owned
-    uint64_t _cursorGen;
+    CursorIndex _cursorIndex;
     int _cursorsCached, _cursorsOut;
+
+    // Cursor cache statistics not yet reported to the WiredTigerSessionCache
+    uint64_t _cursorCacheHits = 0;
+    uint64_t _cursorCacheMisses = 0;
+    uint64_t _cursorCacheEvictions = 0;
 };
 
 /**
@@ -210,6 +230,31 @@ public:
         return _cursorEpoch.load();
     }
 
+    /**
+     * Appends the hits, misses and evictions of the cursor caches of all sessions released so far.
+     */
+    void appendCursorCacheStats(BSONObjBuilder* builder);
+
+    // Machines with more CPUs than this share partitions between CPUs.
+    static const size_t kNumPartitions = 32;
+
+    // How many partitions getSession() looks in, starting with the current CPU's, before it opens
+    // a new session. Bounds the number of spin locks taken when the nearby partitions are empty.
+    static const size_t kMaxPartitionsProbed = 4;
+
+    // ---- Testing API ----
+
+    /**
+     * Makes the calling thread use 'partition' instead of the one for its CPU. Pass boost::none
+     * to go back to using the CPU's partition.
+     */
+    static void setPartitionForCurrentThread_forTest(boost::optional<size_t> partition);
+
+    /**
+     * Returns the number of sessions cached in 'partition'.
+     */
+    size_t getIdleSessionsCount_forTest(size_t partition);
+
 private:
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
@@ -221,9 +266,41 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+
+    // The cached sessions are spread over partitions, chosen by the CPU the calling thread runs
+    // on, so that the short critical sections for getting and releasing a session rarely contend
+    // with other threads. A thread whose partition is empty takes a session from another partition
+    // before opening a new one.
+    // Aligned to a cache line so that neighbouring partitions don't share one.
+    struct alignas(64) SessionCachePartition {
+        SpinLock lock;
+        SessionCache sessions;
+
+        // Cursor cache statistics collected from the sessions released to this partition
+        uint64_t cursorCacheHits = 0;
+        uint64_t cursorCacheMisses = 0;
+        uint64_t cursorCacheEvictions = 0;
+    };
+
+    SessionCachePartition _partitions[kNumPartitions];
+
+    /**
+     * Returns the index of the partition for the CPU the calling thread currently runs on.
+     */
+    static size_t _currentPartition();
+
+    /**
+     * Calls 'func' on every cached session. The sessions of each partition are taken out of the
+     * partition while 'func' runs, so that its lock isn't held while cursors are closed.
+     */
+    void _forEachCachedSession(const stdx::function<void(WiredTigerSession*)>& func);
+
+    /**
+     * Moves the cursor cache statistics of 'session' to 'partition', whose lock must be held.
+     */
+    static void _collectCursorCacheStats(SessionCachePartition* partition,
+                                         WiredTigerSession* session);
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
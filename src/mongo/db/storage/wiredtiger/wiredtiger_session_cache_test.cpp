@@ -0,0 +1,184 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerConnection {
+public:
+    WiredTigerConnection(StringData dbpath) : _conn(NULL) {
+        int ret = wiredtiger_open(dbpath.toString().c_str(), NULL, "create,", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+        ASSERT(_conn);
+    }
+    ~WiredTigerConnection() {
+        _conn->close(_conn, NULL);
+    }
+    WT_CONNECTION* getConnection() const {
+        return _conn;
+    }
+
+private:
+    WT_CONNECTION* _conn;
+};
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest()
+        : _dbpath("wt_session_cache_test"),
+          _connection(_dbpath.path()),
+          _sessionCache(_connection.getConnection()) {}
+
+    void tearDown() override {
+        WiredTigerSessionCache::setPartitionForCurrentThread_forTest(boost::none);
+    }
+
+protected:
+    WiredTigerSessionCache* sessionCache() {
+        return &_sessionCache;
+    }
+
+    void setPartition(size_t partition) {
+        WiredTigerSessionCache::setPartitionForCurrentThread_forTest(partition);
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WiredTigerConnection _connection;
+    WiredTigerSessionCache _sessionCache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedSessionIsReusedFromSamePartition) {
+    setPartition(3);
+    auto session = sessionCache()->getSession();
+    WiredTigerSession* released = session.get();
+    ASSERT_EQUALS(0U, sessionCache()->getIdleSessionsCount_forTest(3));
+
+    session.reset();
+    ASSERT_EQUALS(1U, sessionCache()->getIdleSessionsCount_forTest(3));
+
+    session = sessionCache()->getSession();
+    ASSERT_EQUALS(released, session.get());
+    ASSERT_EQUALS(0U, sessionCache()->getIdleSessionsCount_forTest(3));
+}
+
+TEST_F(WiredTigerSessionCacheTest, SessionIsStolenFromNeighbouringPartition) {
+    setPartition(4);
+    auto session = sessionCache()->getSession();
+    WiredTigerSession* released = session.get();
+    session.reset();
+    ASSERT_EQUALS(1U, sessionCache()->getIdleSessionsCount_forTest(4));
+
+    setPartition(3);
+    session = sessionCache()->getSession();
+    ASSERT_EQUALS(released, session.get());
+    ASSERT_EQUALS(0U, sessionCache()->getIdleSessionsCount_forTest(4));
+}
+
+TEST_F(WiredTigerSessionCacheTest, SessionIsNotStolenBeyondProbedPartitions) {
+    const size_t farPartition = WiredTigerSessionCache::kMaxPartitionsProbed;
+    setPartition(farPartition);
+    auto session = sessionCache()->getSession();
+    WiredTigerSession* released = session.get();
+    session.reset();
+    ASSERT_EQUALS(1U, sessionCache()->getIdleSessionsCount_forTest(farPartition));
+
+    setPartition(0);
+    session = sessionCache()->getSession();
+    ASSERT_NOT_EQUALS(released, session.get());
+    ASSERT_EQUALS(1U, sessionCache()->getIdleSessionsCount_forTest(farPartition));
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllDropsCachedAndOutstandingSessions) {
+    setPartition(5);
+    auto cached = sessionCache()->getSession();
+    auto outstanding = sessionCache()->getSession();
+    cached.reset();
+    ASSERT_EQUALS(1U, sessionCache()->getIdleSessionsCount_forTest(5));
+
+    sessionCache()->closeAll();
+    ASSERT_EQUALS(0U, sessionCache()->getIdleSessionsCount_forTest(5));
+
+    // The session was handed out before closeAll(), so it belongs to an old epoch and must not be
+    // cached again when it is released.
+    outstanding.reset();
+    ASSERT_EQUALS(0U, sessionCache()->getIdleSessionsCount_forTest(5));
+
+    auto session = sessionCache()->getSession();
+    session.reset();
+    ASSERT_EQUALS(1U, sessionCache()->getIdleSessionsCount_forTest(5));
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllCursorsKeepsCachedSessions) {
+    setPartition(6);
+    auto first = sessionCache()->getSession();
+    auto second = sessionCache()->getSession();
+    first.reset();
+    second.reset();
+    ASSERT_EQUALS(2U, sessionCache()->getIdleSessionsCount_forTest(6));
+
+    sessionCache()->closeAllCursors("table:doesnotexist");
+    ASSERT_EQUALS(2U, sessionCache()->getIdleSessionsCount_forTest(6));
+}
+
+TEST_F(WiredTigerSessionCacheTest, MostRecentlyReleasedCursorIsReusedFirst) {
+    auto session = sessionCache()->getSession();
+    WT_SESSION* wtSession = session->getSession();
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:cursors", NULL)));
+
+    const uint64_t id = WiredTigerSession::genTableId();
+    WT_CURSOR* older = session->getCursor("table:cursors", id, true);
+    WT_CURSOR* newer = session->getCursor("table:cursors", id, true);
+    ASSERT(older);
+    ASSERT(newer);
+    ASSERT_NOT_EQUALS(older, newer);
+
+    session->releaseCursor(id, older);
+    session->releaseCursor(id, newer);
+    ASSERT_EQUALS(0, session->cursorsOut());
+
+    ASSERT_EQUALS(newer, session->getCursor("table:cursors", id, true));
+    ASSERT_EQUALS(older, session->getCursor("table:cursors", id, true));
+    ASSERT_EQUALS(2, session->cursorsOut());
+
+    session->releaseCursor(id, older);
+    session->releaseCursor(id, newer);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -142,6 +142,24 @@ void WiredTigerSizeStorer::loadFromCache(StringData uri,
     *dataSize = it->second.dataSize;
 }
 
+void WiredTigerSizeStorer::storeOplogStonesToCache(StringData uri, const BSONObj& oplogStones) {
+    _checkMagic();
+    stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
+    Entry& entry = _entries[uri.toString()];
+    entry.oplogStones = oplogStones.getOwned();
+    entry.dirty = true;
+}
+
+BSONObj WiredTigerSizeStorer::loadOplogStonesFromCache(StringData uri) const {
+    _checkMagic();
+    stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
+    Map::const_iterator it = _entries.find(uri.toString());
+    if (it == _entries.end()) {
+        return BSONObj();
+    }
+    return it->second.oplogStones;
+}
+
 void WiredTigerSizeStorer::fillCache() {
     stdx::lock_guard<stdx::mutex> cursorLock(_cursorMutex);
     _checkMagic();
@@ -170,6 +188,9 @@ void WiredTigerSizeStorer::fillCache() {
             Entry& e = m[uriKey];
             e.numRecords = data["numRecords"].safeNumberLong();
             e.dataSize = data["dataSize"].safeNumberLong();
+            if (data["oplogStones"].type() == Array) {
+                e.oplogStones = data["oplogStones"].Obj().getOwned();
+            }
             e.dirty = false;
             e.rs = NULL;
         }
@@ -222,6 +243,9 @@ void WiredTigerSizeStorer::syncCache(bool syncToDisk) {
             BSONObjBuilder b;
             b.append("numRecords", entry.numRecords);
             b.append("dataSize", entry.dataSize);
+            if (!entry.oplogStones.isEmpty()) {
+                b.appendArray("oplogStones", entry.oplogStones);
+            }
             data = b.obj();
         }
 
@@ -36,6 +36,7 @@
 #include <wiredtiger.h>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/stdx/mutex.h"
 
@@ -59,6 +60,17 @@ public:
 
     void loadFromCache(StringData uri, long long* numRecords, long long* dataSize) const;
 
+    /**
+     * Saves the oplog truncation markers of the record store at 'uri', in the format produced by
+     * WiredTigerRecordStore::OplogStones, so that they need not be recomputed after a restart.
+     */
+    void storeOplogStonesToCache(StringData uri, const BSONObj& oplogStones);
+
+    /**
+     * Returns the oplog truncation markers last saved for 'uri', or an empty object if none were.
+     */
+    BSONObj loadOplogStonesFromCache(StringData uri) const;
+
     /**
      * Loads from the underlying table.
      */
@@ -76,6 +88,7 @@ private:
         Entry() : numRecords(0), dataSize(0), dirty(false), rs(NULL) {}
         long long numRecords;
         long long dataSize;
+        BSONObj oplogStones;  // Empty unless the record store is the oplog.
         bool dirty;
         WiredTigerRecordStore* rs;  // not owned
     };
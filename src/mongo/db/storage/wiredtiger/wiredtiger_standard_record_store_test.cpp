@@ -300,6 +300,171 @@ TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     rs.reset(NULL);  // this has to be deleted before ss
 }
 
+TEST(WiredTigerRecordStoreTest, SizeStorerPersistsOplogStones) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+
+    const string uri = "table:oplogStonesUri";
+    const string sizeStorerUri = "table:sizeStorer";
+    const bool enableWtLogging = false;
+    const BSONObj stones = BSON_ARRAY(BSON("records" << 10LL << "bytes" << 1000LL << "lastRecord"
+                                                     << RecordId(1, 10).repr())
+                                      << BSON("records" << 20LL << "bytes" << 2000LL
+                                                        << "lastRecord"
+                                                        << RecordId(1, 30).repr()));
+
+    {
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, enableWtLogging);
+        ss.storeToCache(uri, 30, 3000);
+        ss.storeOplogStonesToCache(uri, stones);
+        ASSERT_BSONOBJ_EQ(stones, ss.loadOplogStonesFromCache(uri));
+        ss.syncCache(true);
+    }
+
+    WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, enableWtLogging);
+    ss.fillCache();
+    long long numRecords;
+    long long dataSize;
+    ss.loadFromCache(uri, &numRecords, &dataSize);
+    ASSERT_EQUALS(30, numRecords);
+    ASSERT_EQUALS(3000, dataSize);
+    ASSERT_BSONOBJ_EQ(stones, ss.loadOplogStonesFromCache(uri));
+    ASSERT_BSONOBJ_EQ(BSONObj(), ss.loadOplogStonesFromCache("table:otherUri"));
+}
+
+// Restarts an oplog whose stones were saved in the size storer and checks which of them are
+// reused.
+class PersistedOplogStonesTest : public mongo::unittest::Test {
+protected:
+    PersistedOplogStonesTest()
+        : _sizeStorer(_harnessHelper.conn(), "table:sizeStorer", /*enableWtLogging=*/false) {}
+
+    void setUp() override {
+        ServiceContext::UniqueOperationContext opCtx(_harnessHelper.newOperationContext());
+        WiredTigerRecoveryUnit* ru = checked_cast<WiredTigerRecoveryUnit*>(opCtx->recoveryUnit());
+
+        CollectionOptions options;
+        options.capped = true;
+        const bool prefixed = false;
+        StatusWith<std::string> result = WiredTigerRecordStore::generateCreateString(
+            kWiredTigerEngineName, kNs, options, "", prefixed);
+        ASSERT_OK(result.getStatus());
+
+        WriteUnitOfWork uow(opCtx.get());
+        WT_SESSION* s = ru->getSession(opCtx.get())->getSession();
+        invariantWTOK(s->create(s, kUri.c_str(), result.getValue().c_str()));
+        uow.commit();
+    }
+
+    // Opens the oplog, which computes its stones or loads the ones saved in the size storer.
+    // Stones are large enough that computing them over the few records used here finds none.
+    unique_ptr<WiredTigerRecordStore> openOplog() {
+        ServiceContext::UniqueOperationContext opCtx(_harnessHelper.newOperationContext());
+        WiredTigerRecordStore::Params params;
+        params.ns = kNs;
+        params.uri = kUri;
+        params.engineName = kWiredTigerEngineName;
+        params.isCapped = true;
+        params.isEphemeral = false;
+        params.cappedMaxSize = 10 * 1024 * 1024;
+        params.cappedMaxDocs = -1;
+        params.cappedCallback = nullptr;
+        params.sizeStorer = &_sizeStorer;
+
+        auto rs = stdx::make_unique<StandardWiredTigerRecordStore>(opCtx.get(), params);
+        rs->postConstructorInit(opCtx.get());
+        return std::move(rs);
+    }
+
+    // Inserts a small record at each of 'timestamps' and closes the oplog again.
+    void insertRecords(const std::vector<Timestamp>& timestamps) {
+        auto rs = openOplog();
+        ServiceContext::UniqueOperationContext opCtx(_harnessHelper.newOperationContext());
+        for (auto&& ts : timestamps) {
+            BSONObj obj = BSON("ts" << ts);
+            WriteUnitOfWork wuow(opCtx.get());
+            ASSERT_OK(rs->oplogDiskLocRegister(opCtx.get(), ts));
+            auto inserted = rs->insertRecord(opCtx.get(), obj.objdata(), obj.objsize(), false);
+            ASSERT_OK(inserted.getStatus());
+            wuow.commit();
+        }
+    }
+
+    void persistStones(const BSONArray& stones) {
+        _sizeStorer.storeOplogStonesToCache(kUri, stones);
+    }
+
+    static BSONObj stone(long long records, long long bytes, const Timestamp& lastRecord) {
+        return BSON("records" << records << "bytes" << bytes << "lastRecord"
+                              << static_cast<long long>(lastRecord.asULL()));
+    }
+
+    std::string processingMethod(WiredTigerRecordStore* rs) {
+        ServiceContext::UniqueOperationContext opCtx(_harnessHelper.newOperationContext());
+        BSONObjBuilder builder;
+        rs->oplogStones()->appendStats(opCtx.get(), &builder);
+        return builder.obj()["processingMethod"].str();
+    }
+
+    const std::string kNs = "local.oplog.stones";
+    const std::string kUri = "table:local.oplog.stones";
+
+private:
+    WiredTigerHarnessHelper _harnessHelper;
+    WiredTigerSizeStorer _sizeStorer;
+};
+
+TEST_F(PersistedOplogStonesTest, ReusesMatchingStones) {
+    insertRecords({Timestamp(1, 1), Timestamp(1, 2), Timestamp(1, 3), Timestamp(1, 4)});
+    persistStones(BSON_ARRAY(stone(2, 100, Timestamp(1, 2)) << stone(1, 50, Timestamp(1, 3))));
+
+    auto rs = openOplog();
+    ASSERT_EQ("persisted", processingMethod(rs.get()));
+    ASSERT_EQ(2U, rs->oplogStones()->numStones());
+    ASSERT_EQ(1, rs->oplogStones()->currentRecords());
+}
+
+TEST_F(PersistedOplogStonesTest, IgnoresStonesOutOfOrder) {
+    insertRecords({Timestamp(1, 1), Timestamp(1, 2), Timestamp(1, 3), Timestamp(1, 4)});
+    persistStones(BSON_ARRAY(stone(3, 150, Timestamp(1, 3)) << stone(1, 50, Timestamp(1, 2))));
+
+    auto rs = openOplog();
+    ASSERT_EQ("scanning", processingMethod(rs.get()));
+    ASSERT_EQ(0U, rs->oplogStones()->numStones());
+    ASSERT_EQ(4, rs->oplogStones()->currentRecords());
+}
+
+TEST_F(PersistedOplogStonesTest, IgnoresStonesPastNewestRecord) {
+    insertRecords({Timestamp(1, 1), Timestamp(1, 2), Timestamp(1, 3), Timestamp(1, 4)});
+    persistStones(BSON_ARRAY(stone(2, 100, Timestamp(1, 2)) << stone(3, 150, Timestamp(1, 5))));
+
+    auto rs = openOplog();
+    ASSERT_EQ("scanning", processingMethod(rs.get()));
+    ASSERT_EQ(0U, rs->oplogStones()->numStones());
+    ASSERT_EQ(4, rs->oplogStones()->currentRecords());
+}
+
+TEST_F(PersistedOplogStonesTest, DropsStonesAlreadyTruncated) {
+    // The records up to Timestamp(1, 4) were truncated before the stones were saved again.
+    insertRecords({Timestamp(1, 5), Timestamp(1, 6), Timestamp(1, 7), Timestamp(1, 8)});
+    persistStones(BSON_ARRAY(stone(4, 200, Timestamp(1, 4)) << stone(2, 100, Timestamp(1, 6))
+                                                            << stone(1, 50, Timestamp(1, 7))));
+
+    auto rs = openOplog();
+    ASSERT_EQ("persisted", processingMethod(rs.get()));
+    ASSERT_EQ(2U, rs->oplogStones()->numStones());
+    ASSERT_EQ(1, rs->oplogStones()->currentRecords());
+}
+
+TEST_F(PersistedOplogStonesTest, ScansWhenAllStonesAlreadyTruncated) {
+    insertRecords({Timestamp(1, 5), Timestamp(1, 6)});
+    persistStones(BSON_ARRAY(stone(4, 200, Timestamp(1, 4))));
+
+    auto rs = openOplog();
+    ASSERT_EQ("scanning", processingMethod(rs.get()));
+    ASSERT_EQ(0U, rs->oplogStones()->numStones());
+    ASSERT_EQ(2, rs->oplogStones()->currentRecords());
+}
+
 class GoodValidateAdaptor : public ValidateAdaptor {
 public:
     virtual Status validate(const RecordId& recordId, const RecordData& record, size_t* dataSize) {
@@ -34,6 +34,7 @@
 #include <string>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -348,4 +349,37 @@ TEST(WiredTigerUtilTest, GetStatisticsValueAsUInt8) {
     ASSERT_EQUALS(static_cast<uint8_t>(100), resultInt16.getValue());
 }
 
+TEST(WiredTigerSessionCacheTest, CursorCacheReusesCursorsByTableId) {
+    WiredTigerUtilHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+    {
+        UniqueWiredTigerSession session = sessionCache->getSession();
+        WT_SESSION* s = session->getSession();
+        ASSERT_OK(wtRCToStatus(s->create(s, "table:cursorcache", "key_format=q,value_format=u")));
+        ASSERT_OK(wtRCToStatus(s->create(s, "table:othertable", "key_format=q,value_format=u")));
+        const uint64_t tableId = WiredTigerSession::genTableId();
+        const uint64_t otherTableId = WiredTigerSession::genTableId();
+
+        WT_CURSOR* first = session->getCursor("table:cursorcache", tableId, true);
+        ASSERT(first);
+        WT_CURSOR* other = session->getCursor("table:othertable", otherTableId, true);
+        ASSERT(other);
+        session->releaseCursor(tableId, first);
+        session->releaseCursor(otherTableId, other);
+
+        // The cached cursor for the table is found even though it's not the most recently
+        // released one.
+        WT_CURSOR* second = session->getCursor("table:cursorcache", tableId, true);
+        ASSERT_EQUALS(first, second);
+        session->releaseCursor(tableId, second);
+    }
+
+    BSONObjBuilder bob;
+    sessionCache->appendCursorCacheStats(&bob);
+    BSONObj stats = bob.obj()["cursorCache"].Obj();
+    ASSERT_EQUALS(1, stats["hits"].numberLong());
+    ASSERT_EQUALS(2, stats["misses"].numberLong());
+    ASSERT_EQUALS(0, stats["evictions"].numberLong());
+}
+
 }  // namespace mongo
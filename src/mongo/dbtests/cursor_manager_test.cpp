@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <set>
 
 #include <boost/optional/optional.hpp>
 #include <boost/optional/optional_io.hpp>
@@ -273,6 +274,39 @@ TEST_F(CursorManagerTest, ShouldNotBeAbleToKillPinnedCursor) {
               ErrorCodes::OperationFailed);
 }
 
+/**
+ * Test that cursors registered across all partitions get distinct ids, and that a cursor released
+ * back to the manager can be pinned again exactly once.
+ */
+TEST_F(CursorManagerTest, RegisteredCursorsCanBeRepinnedAfterRelease) {
+    CursorManager* cursorManager = useCursorManager();
+
+    const size_t numCursors = 200;
+    std::set<CursorId> cursorIds;
+    for (size_t i = 0; i < numCursors; ++i) {
+        auto cursorPin = cursorManager->registerCursor(
+            _opCtx.get(), {makeFakePlanExecutor(), kTestNss, {}, false, BSONObj()});
+        ASSERT_TRUE(cursorIds.insert(cursorPin.getCursor()->cursorid()).second);
+    }
+    ASSERT_EQ(numCursors, cursorManager->numCursors());
+
+    std::set<CursorId> openCursors;
+    cursorManager->getCursorIds(&openCursors);
+    ASSERT_TRUE(openCursors == cursorIds);
+
+    for (auto cursorId : cursorIds) {
+        auto cursorPin = unittest::assertGet(cursorManager->pinCursor(_opCtx.get(), cursorId));
+        ASSERT_THROWS_CODE(cursorManager->pinCursor(_opCtx.get(), cursorId), UserException, 12051);
+    }
+
+    // Every cursor was unpinned again, so they can all be killed.
+    const bool shouldAudit = false;
+    for (auto cursorId : cursorIds) {
+        ASSERT_OK(cursorManager->eraseCursor(_opCtx.get(), cursorId, shouldAudit));
+    }
+    ASSERT_EQ(0UL, cursorManager->numCursors());
+}
+
 /**
  * Test that client cursors time out and get deleted.
  */
@@ -45,6 +45,8 @@
 #include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
@@ -268,6 +270,116 @@ public:
     }
 };
 
+//
+// Apply the filter on several threads and check that the matching objects still come back in
+// order, in both directions.
+//
+
+class QueryStageCollscanParallelFilter : public QueryStageCollectionScanBase {
+public:
+    QueryStageCollscanParallelFilter()
+        : _oldFilterThreads(internalQueryCollScanFilterThreads.load()) {
+        internalQueryCollScanFilterThreads.store(3);
+    }
+
+    ~QueryStageCollscanParallelFilter() {
+        internalQueryCollScanFilterThreads.store(_oldFilterThreads);
+    }
+
+    void run() {
+        const BSONObj filterObj = BSON("foo" << BSON("$mod" << BSON_ARRAY(2 << 1)));
+        ASSERT_EQUALS(numObj() / 2, countResults(CollectionScanParams::FORWARD, filterObj));
+
+        for (auto direction : {CollectionScanParams::FORWARD, CollectionScanParams::BACKWARD}) {
+            vector<int> results = getFooValues(direction, filterObj);
+            ASSERT_EQUALS(static_cast<size_t>(numObj() / 2), results.size());
+            for (size_t i = 0; i < results.size(); ++i) {
+                const int expected = CollectionScanParams::FORWARD == direction
+                    ? 2 * static_cast<int>(i) + 1
+                    : numObj() - 1 - 2 * static_cast<int>(i);
+                ASSERT_EQUALS(expected, results[i]);
+            }
+        }
+    }
+
+private:
+    vector<int> getFooValues(CollectionScanParams::Direction direction,
+                             const BSONObj& filterObj) {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = direction;
+        params.tailable = false;
+        params.allowParallelFilter = true;
+
+        const CollatorInterface* collator = nullptr;
+        StatusWithMatchExpression statusWithMatcher = MatchExpressionParser::parse(
+            filterObj, ExtensionsCallbackDisallowExtensions(), collator);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        CollectionScan scan(&_opCtx, params, &ws, filterExpr.get());
+
+        vector<int> out;
+        while (!scan.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan.work(&id);
+            if (PlanStage::ADVANCED == state) {
+                out.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+                ws.free(id);
+            }
+        }
+        return out;
+    }
+
+    const int _oldFilterThreads;
+};
+
+//
+// Get the objects a batch at a time. Earlier results in a batch must stay valid while the scan
+// reads the later ones, so their documents are owned on storage engines which don't keep records
+// in place.
+//
+
+class QueryStageCollscanWorkBatch : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+
+        WorkingSet ws;
+        CollectionScan scan(&_opCtx, params, &ws, nullptr);
+
+        const size_t batchSize = 7;
+        int count = 0;
+        std::vector<WorkingSetID> batch;
+        while (!scan.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED != scan.workBatch(batchSize, &ws, &batch, &id)) {
+                continue;
+            }
+            ASSERT_LESS_THAN_OR_EQUALS(batch.size(), batchSize);
+            for (auto&& resultId : batch) {
+                WorkingSetMember* member = ws.get(resultId);
+                if (supportsDocLocking()) {
+                    ASSERT_TRUE(member->obj.value().isOwned());
+                }
+                ASSERT_EQUALS(count, member->obj.value()["foo"].numberInt());
+                ++count;
+                ws.free(resultId);
+            }
+            batch.clear();
+        }
+        ASSERT_EQUALS(numObj(), count);
+    }
+};
+
 //
 // Scan through half the objects, delete the one we're about to fetch, then expect to get the
 // "next" object we would have gotten after that.
@@ -411,6 +523,8 @@ public:
         add<QueryStageCollscanBasicBackwardWithMatch>();
         add<QueryStageCollscanObjectsInOrderForward>();
         add<QueryStageCollscanObjectsInOrderBackward>();
+        add<QueryStageCollscanParallelFilter>();
+        add<QueryStageCollscanWorkBatch>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
         add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
     }
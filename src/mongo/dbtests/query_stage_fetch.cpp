@@ -218,6 +218,79 @@ public:
     }
 };
 
+//
+// Test that fetching a batch of record ids at a time returns every matching document, owned.
+//
+class FetchStageWorkBatch : public QueryStageFetchBase {
+public:
+    void run() {
+        Lock::DBLock lk(&_opCtx, nsToDatabaseSubstring(ns()), MODE_X);
+        OldClientContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(&_opCtx, ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        WorkingSet ws;
+
+        const int numDocs = 20;
+        for (int i = 0; i < numDocs; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(numDocs), recordIds.size());
+
+        // Create a mock stage that returns a WSM in RecordId and index state for each document.
+        auto mockStage = make_unique<QueuedDataStage>(&_opCtx, &ws);
+        for (auto&& recordId : recordIds) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = recordId;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+
+        // Only keep the documents with an even foo.
+        const CollatorInterface* collator = nullptr;
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(fromjson("{foo: {$mod: [2, 0]}}"),
+                                         ExtensionsCallbackDisallowExtensions(),
+                                         collator);
+        verify(statusWithMatcher.isOK());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        unique_ptr<FetchStage> fetchStage(
+            new FetchStage(&_opCtx, &ws, mockStage.release(), filterExpr.get(), coll));
+
+        const size_t batchSize = 3;
+        set<int> found;
+        std::vector<WorkingSetID> batch;
+        while (!fetchStage->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = fetchStage->workBatch(batchSize, &ws, &batch, &id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED != state) {
+                ASSERT_TRUE(batch.empty());
+                continue;
+            }
+            ASSERT_LESS_THAN_OR_EQUALS(batch.size(), batchSize);
+            for (auto&& resultId : batch) {
+                WorkingSetMember* member = ws.get(resultId);
+                ASSERT_TRUE(member->obj.value().isOwned());
+                int foo = member->obj.value()["foo"].numberInt();
+                ASSERT_EQUALS(0, foo % 2);
+                ASSERT_TRUE(found.insert(foo).second);
+            }
+            batch.clear();
+        }
+        ASSERT_EQUALS(size_t(numDocs / 2), found.size());
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -225,6 +298,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageWorkBatch>();
     }
 };
 
@@ -37,6 +37,9 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryStageIxscan {
@@ -95,7 +98,10 @@ public:
     }
 
 
-    IndexScan* createIndexScanSimpleRange(BSONObj startKey, BSONObj endKey) {
+    IndexScan* createIndexScanSimpleRange(BSONObj startKey,
+                                          BSONObj endKey,
+                                          const MatchExpression* filter = nullptr,
+                                          bool allowParallelFilter = false) {
         IndexCatalog* catalog = _coll->getIndexCatalog();
         std::vector<IndexDescriptor*> indexes;
         catalog->findIndexesByKeyPattern(&_opCtx, BSON("x" << 1), false, &indexes);
@@ -109,9 +115,9 @@ public:
         params.bounds.endKey = endKey;
         params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
         params.direction = 1;
+        params.allowParallelFilter = allowParallelFilter;
 
         // This child stage gets owned and freed by the caller.
-        MatchExpression* filter = NULL;
         return new IndexScan(&_opCtx, params, &_ws, filter);
     }
 
@@ -314,6 +320,94 @@ public:
     }
 };
 
+// Applying the filter on several threads should return the same keys in the same order.
+class QueryStageIxscanParallelFilter : public IndexScanTest {
+public:
+    QueryStageIxscanParallelFilter()
+        : _oldFilterThreads(internalQueryIndexScanFilterThreads.load()) {
+        internalQueryIndexScanFilterThreads.store(3);
+    }
+
+    ~QueryStageIxscanParallelFilter() {
+        internalQueryIndexScanFilterThreads.store(_oldFilterThreads);
+    }
+
+    void run() {
+        setup();
+
+        for (int i = 0; i < 50; ++i) {
+            insert(BSON("_id" << i << "x" << i));
+        }
+
+        const CollatorInterface* collator = nullptr;
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(fromjson("{x: {$mod: [3, 0]}}"),
+                                         ExtensionsCallbackDisallowExtensions(),
+                                         collator);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        std::unique_ptr<MatchExpression> filter = std::move(statusWithMatcher.getValue());
+
+        std::unique_ptr<IndexScan> ixscan(
+            createIndexScanSimpleRange(BSON("x" << 0), BSON("x" << 49), filter.get(), true));
+
+        for (int i = 0; i < 50; i += 3) {
+            WorkingSetMember* member = getNext(ixscan.get());
+            ASSERT_EQ(WorkingSetMember::RID_AND_IDX, member->getState());
+            ASSERT_BSONOBJ_EQ(member->keyData[0].keyData, BSON("" << i));
+        }
+
+        WorkingSetID id;
+        ASSERT_EQ(PlanStage::IS_EOF, ixscan->work(&id));
+        ASSERT(ixscan->isEOF());
+    }
+
+private:
+    const int _oldFilterThreads;
+};
+
+// Getting the keys a batch at a time should return the same keys in the same order.
+class QueryStageIxscanWorkBatch : public IndexScanTest {
+public:
+    void run() {
+        setup();
+
+        for (int i = 0; i < 50; ++i) {
+            insert(BSON("_id" << i << "x" << i));
+        }
+
+        const CollatorInterface* collator = nullptr;
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(fromjson("{x: {$mod: [3, 0]}}"),
+                                         ExtensionsCallbackDisallowExtensions(),
+                                         collator);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        std::unique_ptr<MatchExpression> filter = std::move(statusWithMatcher.getValue());
+
+        std::unique_ptr<IndexScan> ixscan(
+            createIndexScanSimpleRange(BSON("x" << 0), BSON("x" << 49), filter.get()));
+
+        const size_t batchSize = 4;
+        int nextX = 0;
+        std::vector<WorkingSetID> batch;
+        while (!ixscan->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED != ixscan->workBatch(batchSize, &_ws, &batch, &id)) {
+                ASSERT_TRUE(batch.empty());
+                continue;
+            }
+            ASSERT_LESS_THAN_OR_EQUALS(batch.size(), batchSize);
+            for (auto&& resultId : batch) {
+                WorkingSetMember* member = _ws.get(resultId);
+                ASSERT_EQ(WorkingSetMember::RID_AND_IDX, member->getState());
+                ASSERT_BSONOBJ_EQ(member->keyData[0].keyData, BSON("" << nextX));
+                nextX += 3;
+            }
+            batch.clear();
+        }
+        ASSERT_EQ(51, nextX);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_ixscan") {}
@@ -324,6 +418,8 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanParallelFilter>();
+        add<QueryStageIxscanWorkBatch>();
     }
 } QueryStageIxscanAll;
 
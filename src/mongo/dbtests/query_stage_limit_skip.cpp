@@ -87,6 +87,31 @@ int countResults(PlanStage* stage) {
     return count;
 }
 
+/**
+ * Like countResults(), but gets results from 'stage' with workBatch(). Also checks that the
+ * results are the consecutive 'x' values starting at 'firstX'.
+ */
+int countResultsInBatches(PlanStage* stage, WorkingSet* ws, size_t batchSize, int firstX) {
+    int count = 0;
+    std::vector<WorkingSetID> batch;
+    while (!stage->isEOF()) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState status = stage->workBatch(batchSize, ws, &batch, &id);
+        if (PlanStage::ADVANCED != status) {
+            ASSERT_TRUE(batch.empty());
+            continue;
+        }
+        ASSERT_FALSE(batch.empty());
+        ASSERT_LESS_THAN_OR_EQUALS(batch.size(), batchSize);
+        for (auto&& resultId : batch) {
+            ASSERT_EQUALS(firstX + count, ws->get(resultId)->obj.value()["x"].numberInt());
+            ++count;
+        }
+        batch.clear();
+    }
+    return count;
+}
+
 //
 // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
 //
@@ -110,12 +135,74 @@ protected:
     OperationContext* const _opCtx = _uniqOpCtx.get();
 };
 
+//
+// Same as above, but getting the results a batch at a time with various batch sizes.
+//
+class QueryStageLimitSkipBatchTest {
+public:
+    void run() {
+        for (size_t batchSize : {1U, 2U, 7U, 1000U}) {
+            for (int i = 0; i < 2 * N; ++i) {
+                WorkingSet ws;
+
+                unique_ptr<PlanStage> skip =
+                    make_unique<SkipStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(max(0, N - i), countResultsInBatches(skip.get(), &ws, batchSize, i));
+
+                unique_ptr<PlanStage> limit =
+                    make_unique<LimitStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(min(N, i), countResultsInBatches(limit.get(), &ws, batchSize, 0));
+            }
+        }
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _uniqOpCtx = cc().makeOperationContext();
+    OperationContext* const _opCtx = _uniqOpCtx.get();
+};
+
+//
+// A batch ends early once its results get large, whatever batch size was asked for.
+//
+class QueryStageLimitSkipBatchBytesTest : public QueryStageLimitSkipBatchTest {
+public:
+    void run() {
+        const int numDocs = 10;
+        const std::string bigString(1024 * 1024, 'a');
+
+        WorkingSet ws;
+        auto ms = make_unique<QueuedDataStage>(_opCtx, &ws);
+        for (int i = 0; i < numDocs; ++i) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* wsm = ws.get(id);
+            wsm->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("x" << i << "s" << bigString));
+            wsm->transitionToOwnedObj();
+            ms->pushBack(id);
+        }
+        unique_ptr<PlanStage> limit = make_unique<LimitStage>(_opCtx, numDocs, &ws, ms.release());
+
+        std::vector<WorkingSetID> batch;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ASSERT_EQUALS(PlanStage::ADVANCED, limit->workBatch(numDocs, &ws, &batch, &id));
+        ASSERT_FALSE(batch.empty());
+        ASSERT_LESS_THAN(batch.size(), static_cast<size_t>(numDocs));
+        ASSERT_LESS_THAN_OR_EQUALS(batch.size(),
+                                   PlanStage::kMaxWorkBatchBytes / bigString.size() + 1);
+
+        const int numInFirstBatch = static_cast<int>(batch.size());
+        ASSERT_EQUALS(numDocs - numInFirstBatch,
+                      countResultsInBatches(limit.get(), &ws, numDocs, numInFirstBatch));
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_limit_skip") {}
 
     void setupTests() {
         add<QueryStageLimitSkipBasicTest>();
+        add<QueryStageLimitSkipBatchTest>();
+        add<QueryStageLimitSkipBatchBytesTest>();
     }
 };
 
@@ -37,13 +37,12 @@
 #include "mongo/platform/bits.h"
 
 namespace mongo {
-namespace unicode {
 
 /**
  * A sequence of bytes that can be manipulated using vectorized instructions.
  *
- * This is specific to the use case in mongo::unicode::String and not intended as a general purpose
- * vector class.
+ * It only offers the operations needed by mongo::unicode::String and by KeyString's bit flipping,
+ * and is not intended as a general purpose vector class.
  *
  * This specialization offers acceleration for ppc64le
  */
@@ -150,11 +149,18 @@ public:
         return (*this = (*this & other));
     }
 
+    ByteVector operator^(ByteVector other) const {
+        return (Native)vec_xor(_data, other._data);
+    }
+
+    ByteVector& operator^=(ByteVector other) {
+        return (*this = (*this ^ other));
+    }
+
 private:
     ByteVector(Native data) : _data(data) {}
 
     Native _data;
 };
 
-}  // namespace unicode
 }  // namespace mongo
@@ -56,11 +56,15 @@ AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams* params)
     : _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort)) {
-    size_t remoteIndex = 0;
+      _mergeTree(_remotes, MergingComparator(_remotes, _params->sort)) {
+    _remotes.reserve(_params->remotes.size());
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort, remote.cursorResponse.getCursorId());
+    }
+    _mergeTree.reset(_remotes.size());
 
+    size_t remoteIndex = 0;
+    for (const auto& remote : _params->remotes) {
         // We don't check the return value of addBatchToBuffer here; if there was an error,
         // it will be stored in the remote and the first call to ready() will return true.
         addBatchToBuffer(remoteIndex, remote.cursorResponse.getBatch());
@@ -174,6 +178,15 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
         return _status;
     }
 
+    // A remote reading ahead can fail its outstanding getMore between the caller's ready() and
+    // this call while it still has results buffered, so check for errors again before merging.
+    for (const auto& remote : _remotes) {
+        if (!remote.status.isOK()) {
+            _status = remote.status;
+            return _status;
+        }
+    }
+
     if (_eofNext) {
         _eofNext = false;
         return {ClusterQueryResult()};
@@ -187,24 +200,19 @@ ClusterQueryResult AsyncResultsMerger::nextReadySorted() {
     // Tailable cursors cannot have a sort.
     invariant(!_params->isTailable);
 
-    if (_mergeQueue.empty()) {
+    size_t smallestRemote = _mergeTree.winner();
+    if (smallestRemote == MergingTournamentTree::kNoRemote) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
-
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
     ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
     _remotes[smallestRemote].docBuffer.pop();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
+    // Replay the tournament with the next result from 'smallestRemote', if it has a next result.
+    _mergeTree.update(smallestRemote);
 
     return front;
 }
@@ -279,6 +287,26 @@ Status AsyncResultsMerger::askForNextBatch_inlock(OperationContext* opCtx, size_
     return Status::OK();
 }
 
+bool AsyncResultsMerger::shouldAskForNextBatch_inlock(size_t remoteIndex) const {
+    const auto& remote = _remotes[remoteIndex];
+    if (remote.exhausted() || remote.cbHandle.isValid()) {
+        return false;
+    }
+
+    if (!remote.hasNext()) {
+        return true;
+    }
+
+    // Batches received from remote tailable cursors are passed through to the client as they are,
+    // so there is nothing to read ahead of.
+    if (_params->isTailable || _params->readAheadBatches <= 0) {
+        return false;
+    }
+
+    return remote.docBuffer.size() <=
+        static_cast<size_t>(_params->readAheadBatches) * remote.lastBatchSize;
+}
+
 /*
  * Note: When nextEvent() is called to do retries, only the remotes with retriable errors will
  * be rescheduled because:
@@ -312,9 +340,9 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent(
             return remote.status;
         }
 
-        if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
-            // If this remote is not exhausted and there is no outstanding request for it, schedule
-            // work to retrieve the next batch.
+        if (shouldAskForNextBatch_inlock(i)) {
+            // If this remote is not exhausted, there is no outstanding request for it and it is
+            // running low on buffered results, schedule work to retrieve the next batch.
             auto nextBatchStatus = askForNextBatch_inlock(opCtx, i);
             if (!nextBatchStatus.isOK()) {
                 return nextBatchStatus;
@@ -419,10 +447,14 @@ void AsyncResultsMerger::handleBatchResponse(
         if (_params->isAllowPartialResults) {
             remote.status = Status::OK();
 
-            // Clear the results buffer and cursor id.
+            // Clear the results buffer and cursor id. With read-ahead the buffer may not have
+            // been empty, in which case the remote must also leave the merge.
             std::queue<ClusterQueryResult> emptyBuffer;
             std::swap(remote.docBuffer, emptyBuffer);
             remote.cursorId = 0;
+            if (!_params->sort.isEmpty()) {
+                _mergeTree.update(remoteIndex);
+            }
         }
 
         return;
@@ -449,11 +481,12 @@ void AsyncResultsMerger::handleBatchResponse(
     }
 
     // If even after receiving this batch we still don't have anything buffered (i.e. the batchSize
-    // was zero), then can schedule work to retrieve the next batch right away.
+    // was zero), or we are reading ahead and have fewer batches buffered than requested, then can
+    // schedule work to retrieve the next batch right away.
     //
     // We do not ask for the next batch if the cursor is tailable, as batches received from remote
     // tailable cursors should be passed through to the client without asking for more batches.
-    if (!_params->isTailable && !remote.hasNext() && !remote.exhausted()) {
+    if (!_params->isTailable && shouldAskForNextBatch_inlock(remoteIndex)) {
         remote.status = askForNextBatch_inlock(opCtx, remoteIndex);
         if (!remote.status.isOK()) {
             return;
@@ -485,10 +518,13 @@ bool AsyncResultsMerger::addBatchToBuffer(size_t remoteIndex, const std::vector<
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
-    if (!_params->sort.isEmpty() && !batch.empty()) {
-        _mergeQueue.push(remoteIndex);
+    remote.lastBatchSize = batch.size();
+
+    // If we're doing a sorted merge, then we have to make sure this remote takes part in the
+    // merge. Replaying its matches is only needed if its buffer used to be empty, since otherwise
+    // the front of the buffer has not changed.
+    if (!_params->sort.isEmpty() && !batch.empty() && remote.docBuffer.size() == batch.size()) {
+        _mergeTree.update(remoteIndex);
     }
     return true;
 }
@@ -607,7 +643,8 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 // AsyncResultsMerger::MergingComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs,
+                                                       const size_t& rhs) const {
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -619,4 +656,41 @@ bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const
     return leftDocKey.woCompare(rightDocKey, _sort, false /*considerFieldName*/) > 0;
 }
 
+//
+// AsyncResultsMerger::MergingTournamentTree
+//
+
+constexpr size_t AsyncResultsMerger::MergingTournamentTree::kNoRemote;
+
+void AsyncResultsMerger::MergingTournamentTree::reset(size_t numRemotes) {
+    _numLeaves = 1;
+    while (_numLeaves < numRemotes) {
+        _numLeaves *= 2;
+    }
+    _nodes.assign(2 * _numLeaves, kNoRemote);
+}
+
+void AsyncResultsMerger::MergingTournamentTree::update(size_t remoteIndex) {
+    invariant(remoteIndex < _numLeaves);
+
+    size_t node = _numLeaves + remoteIndex;
+    _nodes[node] = _remotes[remoteIndex].hasNext() ? remoteIndex : kNoRemote;
+
+    for (node /= 2; node > 0; node /= 2) {
+        _nodes[node] = _playMatch(_nodes[2 * node], _nodes[2 * node + 1]);
+    }
+}
+
+size_t AsyncResultsMerger::MergingTournamentTree::_playMatch(size_t lhs, size_t rhs) const {
+    if (lhs == kNoRemote) {
+        return rhs;
+    }
+    if (rhs == kNoRemote) {
+        return lhs;
+    }
+
+    // Ties go to the left so that equal results are returned in remote order.
+    return _comparator(lhs, rhs) ? rhs : lhs;
+}
+
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <limits>
 #include <queue>
 #include <vector>
 
@@ -66,6 +67,10 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * If ClusterClientCursorParams::readAheadBatches is non-zero, getMores are also issued to remotes
+ * which still have buffered results, so that the next batch from each remote is already on its
+ * way by the time the merge needs it.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -79,8 +84,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, enters the remotes with
+     * buffered results into _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      */
@@ -224,6 +229,10 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The number of documents in the most recent batch received from this remote. Used to
+        // decide how many documents make up the read-ahead window.
+        size_t lastBatchSize = 0;
     };
 
     class MergingComparator {
@@ -231,7 +240,10 @@ private:
         MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
             : _remotes(remotes), _sort(sort) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Returns true if the next buffered result of remote 'lhs' sorts after that of 'rhs'.
+         */
+        bool operator()(const size_t& lhs, const size_t& rhs) const;
 
     private:
         const std::vector<RemoteCursorData>& _remotes;
@@ -239,6 +251,56 @@ private:
         const BSONObj& _sort;
     };
 
+    /**
+     * A tournament (winner) tree over the remotes, used to merge their sorted streams. Each leaf
+     * stands for one remote, and each internal node holds the index of the remote with the
+     * smallest next buffered result in its subtree. Remotes with nothing buffered never win a
+     * match.
+     *
+     * Unlike a priority queue, which needs a pop and a push for every result returned, a change
+     * to the front of any one remote's buffer is absorbed by replaying the matches on the path
+     * from its leaf to the root, which is a single comparison per level.
+     */
+    class MergingTournamentTree {
+    public:
+        static constexpr size_t kNoRemote = std::numeric_limits<size_t>::max();
+
+        MergingTournamentTree(const std::vector<RemoteCursorData>& remotes,
+                              MergingComparator comparator)
+            : _remotes(remotes), _comparator(std::move(comparator)) {}
+
+        /**
+         * Sizes the tree for 'numRemotes' leaves, none of which have buffered results.
+         */
+        void reset(size_t numRemotes);
+
+        /**
+         * Returns the index of the remote with the next result in sort order, or kNoRemote if no
+         * remote has anything buffered.
+         */
+        size_t winner() const {
+            return _nodes[1];
+        }
+
+        /**
+         * Must be called whenever the front of the buffer of remote 'remoteIndex' changes,
+         * including when the buffer becomes empty or non-empty.
+         */
+        void update(size_t remoteIndex);
+
+    private:
+        size_t _playMatch(size_t lhs, size_t rhs) const;
+
+        const std::vector<RemoteCursorData>& _remotes;
+
+        MergingComparator _comparator;
+
+        // The tree is stored as an implicit binary heap: the children of node 'i' are '2i' and
+        // '2i + 1', the root is node 1 and the leaves occupy [_numLeaves, 2 * _numLeaves).
+        size_t _numLeaves = 1;
+        std::vector<size_t> _nodes = std::vector<size_t>(2, kNoRemote);
+    };
+
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
 
     /**
@@ -265,6 +327,14 @@ private:
      */
     Status askForNextBatch_inlock(OperationContext* opCtx, size_t remoteIndex);
 
+    /**
+     * Returns true if a getMore should be sent to the remote at 'remoteIndex' now. This is the
+     * case if the remote is neither exhausted nor already waiting on a response, and either it has
+     * nothing buffered, or read-ahead is enabled and no more than 'readAheadBatches' batches'
+     * worth of its results remain buffered.
+     */
+    bool shouldAskForNextBatch_inlock(size_t remoteIndex) const;
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -338,9 +408,9 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
+    // The winner of this tournament is the index into '_remotes' for the remote host that has the
     // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    MergingTournamentTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
@@ -446,6 +446,146 @@ TEST_F(AsyncResultsMergerTest, MultiShardSorted) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedReadAheadRequestsNextBatchesBeforeBuffersAreEmpty) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    std::vector<BSONObj> firstBatch0 = {fromjson("{$sortKey: {'': 1}}"),
+                                        fromjson("{$sortKey: {'': 4}}")};
+    std::vector<BSONObj> firstBatch1 = {fromjson("{$sortKey: {'': 2}}"),
+                                        fromjson("{$sortKey: {'': 3}}")};
+    std::vector<BSONObj> firstBatch2 = {fromjson("{$sortKey: {'': 8}}")};
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch0)));
+    cursors.emplace_back(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, std::move(firstBatch1)));
+    cursors.emplace_back(
+        kTestShardIds[2], kTestShardHosts[2], CursorResponse(_nss, 0, std::move(firstBatch2)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+    _params->readAheadBatches = 1;
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 3}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+
+    // The second shard's buffer is empty, so the merge has to wait for it.
+    ASSERT_FALSE(arm->ready());
+
+    // Scheduling work asks the second shard for its next batch, and also reads ahead from the
+    // first shard, which has only one result left buffered. The third shard is exhausted.
+    auto readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+    ASSERT_EQ(kTestShardHosts[0], getFirstPendingRequest().target);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch0 = {fromjson("{$sortKey: {'': 5}}"),
+                                   fromjson("{$sortKey: {'': 7}}")};
+    responses.emplace_back(_nss, CursorId(5), batch0);
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 6}}")};
+    responses.emplace_back(_nss, CursorId(0), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    // The first shard now has more than a batch buffered, so no further read-ahead is issued.
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    ASSERT_TRUE(arm->ready());
+    executor()->waitForEvent(readyEvent);
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 4}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 5}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 6}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 7}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // The first shard closes its cursor, after which the result buffered from the third shard
+    // is returned.
+    readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+    responses.clear();
+    responses.emplace_back(_nss, CursorId(0), std::vector<BSONObj>());
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(arm->remotesExhausted());
+    executor()->waitForEvent(readyEvent);
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 8}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, SortedReadAheadErrorWithBufferedResultsIsReturned) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    std::vector<BSONObj> firstBatch0 = {fromjson("{$sortKey: {'': 1}}"),
+                                        fromjson("{$sortKey: {'': 4}}")};
+    std::vector<BSONObj> firstBatch1 = {fromjson("{$sortKey: {'': 2}}")};
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch0)));
+    cursors.emplace_back(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, std::move(firstBatch1)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+    _params->readAheadBatches = 1;
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // Both shards are asked for their next batch, the first one while it still has a result
+    // buffered.
+    auto readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    auto readAheadRequest = net->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHosts[0], readAheadRequest->getRequest().target);
+    auto refillRequest = net->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHosts[1], refillRequest->getRequest().target);
+
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 3}}")};
+    RemoteCommandResponse refillResponse(
+        CursorResponse(_nss, CursorId(0), batch1)
+            .toBSON(CursorResponse::ResponseType::SubsequentResponse),
+        BSONObj(),
+        Milliseconds(0));
+    net->scheduleResponse(refillRequest, net->now(), ResponseStatus(refillResponse));
+    net->runReadyNetworkOperations();
+    net->exitNetwork();
+
+    ASSERT_TRUE(arm->ready());
+    executor()->waitForEvent(readyEvent);
+
+    // The read-ahead getMore fails after the caller saw the merger ready, while the first shard
+    // still has a result buffered.
+    net->enterNetwork();
+    ResponseStatus error(ErrorCodes::BadValue, "bad thing happened", Milliseconds(0));
+    net->scheduleResponse(readAheadRequest, net->now(), error);
+    net->runReadyNetworkOperations();
+    net->exitNetwork();
+
+    auto statusWithNext = arm->nextReady();
+    ASSERT_EQ(ErrorCodes::BadValue, statusWithNext.getStatus().code());
+    ASSERT_EQ("bad thing happened", statusWithNext.getStatus().reason());
+    ASSERT_TRUE(arm->ready());
+}
+
 TEST_F(AsyncResultsMergerTest, MultiShardMultipleGets) {
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
     cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
@@ -126,6 +126,11 @@ struct ClusterClientCursorParams {
     // Whether the client indicated that it is willing to receive partial results in the case of an
     // unreachable host.
     bool isAllowPartialResults = false;
+
+    // The number of batches, in addition to the one currently buffered, which may be requested
+    // ahead of time from each remote. Zero disables read-ahead, in which case a getMore is only
+    // sent to a remote once everything buffered from it has been returned.
+    long long readAheadBatches = 0;
 };
 
 }  // mongo
@@ -51,6 +51,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/query/cluster_client_cursor_impl.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/s/query/establish_cursors.h"
 #include "mongo/s/query/store_possible_cursor.h"
 #include "mongo/s/stale_exception.h"
@@ -206,6 +207,10 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* opCtx,
     // being considered a hint to use a collection scan.
     if (!query.getQueryRequest().getSort().hasField("$natural")) {
         params.sort = FindCommon::transformSortSpec(query.getQueryRequest().getSort());
+
+        // A sorted merge cannot return anything until every shard has buffered results, so keep
+        // further batches in flight rather than waiting on each shard's round trip in turn.
+        params.readAheadBatches = std::max(0, internalQueryMongosReadAheadBatches.load());
     }
 
     // Tailable cursors can't have a sort, which should have already been validated.
@@ -45,4 +45,9 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// The number of batches mongos requests ahead from each shard when merging a sorted find. Zero by
+// default, meaning that a shard is only asked for its next batch once mongos has consumed
+// everything it buffered from that shard.
+extern AtomicInt32 internalQueryMongosReadAheadBatches;
+
 }  // namespace mongo
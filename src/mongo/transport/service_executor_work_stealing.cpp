@@ -0,0 +1,435 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_work_stealing.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/stringutils.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+namespace {
+// The number of worker threads which own a task queue. If the value is -1 (the default) then it
+// will be set to the number of available cores.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(workStealingServiceExecutorThreads, int, -1);
+
+// Whether to bind each worker thread to its own CPU.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(workStealingServiceExecutorPinThreads, bool, false);
+
+// The amount of time queued tasks may make no progress before the controller thread starts extra
+// worker threads to unblock the executor.
+MONGO_EXPORT_SERVER_PARAMETER(workStealingServiceExecutorStuckThreadTimeoutMillis, int, 250);
+
+// Idle worker threads wait for network I/O for at most this many milliseconds before looking for
+// tasks to steal again. Extra worker threads exit after being idle for this long.
+MONGO_EXPORT_SERVER_PARAMETER(workStealingServiceExecutorIdlePollMillis, int, 100);
+
+// Workers which always find tasks in their queues still service network I/O every this many tasks.
+constexpr int kTasksBetweenNetworkPolls = 16;
+
+// The executor and queue of the worker thread running on this thread, if any. Used to schedule
+// tasks onto the queue of the worker which scheduled them.
+thread_local const ServiceExecutorWorkStealing* currentExecutor = nullptr;
+thread_local size_t currentQueueId = 0;
+
+constexpr auto kTotalScheduled = "totalScheduled"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kQueueDepth = "queueDepth"_sd;
+constexpr auto kTasksExecuting = "tasksExecuting"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kExtraThreadsRunning = "extraThreadsRunning"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "workStealing"_sd;
+
+struct ServerParameterOptions : public ServiceExecutorWorkStealing::Options {
+    int workerThreads() const final {
+        int value = workStealingServiceExecutorThreads;
+        if (value == -1) {
+            ProcessInfo pi;
+            value = pi.getNumAvailableCores().value_or(pi.getNumCores());
+            value = std::max(value, 2);
+            workStealingServiceExecutorThreads = value;
+            log() << "No thread count configured for executor. Using number of cores: " << value;
+        }
+        return value;
+    }
+
+    bool pinWorkerThreads() const final {
+        return workStealingServiceExecutorPinThreads;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return Milliseconds{workStealingServiceExecutorStuckThreadTimeoutMillis.load()};
+    }
+
+    Milliseconds idlePollInterval() const final {
+        return Milliseconds{workStealingServiceExecutorIdlePollMillis.load()};
+    }
+};
+
+/**
+ * Returns the CPUs this process may run on, in ascending order, or an empty vector if they cannot
+ * be determined on this platform.
+ */
+std::vector<int> getAllowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        auto ec = errno;
+        warning() << "Unable to determine CPU affinity of the process: " << errnoWithDescription(ec)
+                  << ". Worker threads will not be pinned.";
+        return cpus;
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set))
+            cpus.push_back(cpu);
+    }
+#else
+    warning() << "Pinning worker threads is not supported on this platform.";
+#endif
+    return cpus;
+}
+
+void pinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        warning() << "Unable to pin worker thread to CPU " << cpu << ": "
+                  << errnoWithDescription(ret);
+    }
+#endif
+}
+
+}  // namespace
+
+ServiceExecutorWorkStealing::ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                                         std::shared_ptr<asio::io_context> ioCtx)
+    : ServiceExecutorWorkStealing(
+          ctx, std::move(ioCtx), stdx::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorWorkStealing::ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                                         std::shared_ptr<asio::io_context> ioCtx,
+                                                         std::unique_ptr<Options> config)
+    : _ioContext(std::move(ioCtx)), _config(std::move(config)) {}
+
+ServiceExecutorWorkStealing::~ServiceExecutorWorkStealing() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorWorkStealing::start() {
+    invariant(!_isRunning.load());
+
+    const auto workerThreads = _config->workerThreads();
+    invariant(workerThreads > 0);
+
+    // The queues are allocated once and never resized, so workers and schedulers may index into
+    // _queues without synchronization.
+    _queues.clear();
+    for (int i = 0; i < workerThreads; i++) {
+        _queues.push_back(stdx::make_unique<WorkerQueue>());
+    }
+
+    if (_config->pinWorkerThreads()) {
+        _workerCpus = getAllowedCpus();
+        if (!_workerCpus.empty() && static_cast<size_t>(workerThreads) > _workerCpus.size()) {
+            warning() << "Configured " << workerThreads << " worker threads but only "
+                      << _workerCpus.size() << " CPUs are available, some CPUs will be shared";
+        }
+    }
+
+    _isRunning.store(true);
+    _controllerThread =
+        stdx::thread(&ServiceExecutorWorkStealing::_controllerThreadRoutine, this);
+    for (size_t i = 0; i < _queues.size(); i++) {
+        _startWorkerThread(i);
+    }
+
+    return Status::OK();
+}
+
+Status ServiceExecutorWorkStealing::shutdown() {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_controllerMutex);
+        _controllerCondition.notify_one();
+    }
+    _controllerThread.join();
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    _ioContext->stop();
+    _deathCondition.wait(lk, [&] { return _threads.empty(); });
+
+    return Status::OK();
+}
+
+Status ServiceExecutorWorkStealing::schedule(Task task, ScheduleFlags flags) {
+    // Tasks scheduled by a worker stay on that worker's queue, everything else (and tasks
+    // scheduled by extra workers) is spread over all the queues.
+    const bool fromOwnWorker = (currentExecutor == this) && (currentQueueId != kNoQueue);
+    const size_t queueId =
+        fromOwnWorker ? currentQueueId : _nextQueue.fetchAndAdd(1) % _queues.size();
+
+    {
+        auto& queue = *_queues[queueId];
+        stdx::lock_guard<stdx::mutex> lk(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    _tasksPending.addAndFetch(1);
+    _totalScheduled.addAndFetch(1);
+
+    // A deferred task scheduled by a worker will be run by that worker once it's done with its
+    // current task, so there is no need to wake anyone up. Otherwise wake up an idle worker, which
+    // will pick up the task from its own queue or steal it. Posting to the io_context after
+    // publishing the task pairs with the idle worker checking _tasksPending after announcing itself
+    // as idle, so a wakeup cannot get lost.
+    if (!(fromOwnWorker && (flags & DeferredTask)) && _workersIdle.load() > 0) {
+        _ioContext->post([] {});
+    }
+
+    return Status::OK();
+}
+
+bool ServiceExecutorWorkStealing::_popTask(size_t queueId, Task* task) {
+    if (queueId == kNoQueue)
+        return false;
+
+    auto& queue = *_queues[queueId];
+    stdx::lock_guard<stdx::mutex> lk(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+
+    *task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ServiceExecutorWorkStealing::_stealTask(size_t queueId, Task* task) {
+    // Visit the neighbouring queues first. When workers are pinned, neighbours run on CPUs with
+    // neighbouring numbers, which often share caches with this one.
+    const size_t numQueues = _queues.size();
+    const size_t start = (queueId == kNoQueue) ? _nextQueue.load() % numQueues : queueId + 1;
+    for (size_t i = 0; i < numQueues; i++) {
+        const size_t victim = (start + i) % numQueues;
+        if (victim == queueId)
+            continue;
+
+        auto& queue = *_queues[victim];
+        stdx::unique_lock<stdx::mutex> lk(queue.mutex, stdx::try_to_lock);
+        if (!lk.owns_lock() || queue.tasks.empty())
+            continue;
+
+        // Take the oldest task, it's the one which has been stuck behind the victim's current task
+        // for the longest.
+        *task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        _totalStolen.addAndFetch(1);
+        return true;
+    }
+    return false;
+}
+
+void ServiceExecutorWorkStealing::_runTask(Task task) {
+    _tasksPending.subtractAndFetch(1);
+    _tasksExecuting.addAndFetch(1);
+
+    const auto guard = MakeGuard([this] {
+        _tasksExecuting.subtractAndFetch(1);
+        _totalExecuted.addAndFetch(1);
+    });
+
+    task();
+}
+
+void ServiceExecutorWorkStealing::_controllerThreadRoutine() {
+    setThreadName("worker-controller"_sd);
+
+    int64_t lastExecuted = _totalExecuted.load();
+    stdx::unique_lock<stdx::mutex> lk(_controllerMutex);
+    while (_isRunning.load()) {
+        _controllerCondition.wait_for(lk, _config->stuckThreadTimeout().toSystemDuration());
+
+        // If the executor has stopped, then stop the controller altogether
+        if (!_isRunning.load())
+            break;
+
+        // If there are tasks waiting, but no worker has finished a task since the last round,
+        // then every worker is stuck in a long running task (or blocked waiting on a task that is
+        // still queued). Start extra workers which steal the queued tasks to guarantee progress.
+        const auto executed = _totalExecuted.load();
+        const auto pending = _tasksPending.load();
+        if (pending > 0 && executed == lastExecuted) {
+            const auto toStart = std::min<size_t>(pending, _queues.size());
+            log() << "Detected blocked worker threads, starting " << toStart
+                  << " extra worker threads to unblock service executor";
+            for (size_t i = 0; i < toStart; i++) {
+                _startWorkerThread(kNoQueue);
+            }
+        }
+        lastExecuted = executed;
+    }
+}
+
+void ServiceExecutorWorkStealing::_startWorkerThread(size_t queueId) {
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    auto it = _threads.emplace(_threads.begin());
+    auto num = _threads.size();
+
+    _threadsRunning.addAndFetch(1);
+    if (queueId == kNoQueue)
+        _extraThreadsRunning.addAndFetch(1);
+    *it = stdx::thread(&ServiceExecutorWorkStealing::_workerThreadRoutine, this, queueId, num, it);
+}
+
+void ServiceExecutorWorkStealing::_workerThreadRoutine(
+    size_t queueId, int threadId, ServiceExecutorWorkStealing::ThreadList::iterator it) {
+    const bool isExtraWorker = (queueId == kNoQueue);
+    {
+        std::string threadName = str::stream() << "worker-" << threadId;
+        setThreadName(threadName);
+    }
+
+    if (isExtraWorker) {
+        log() << "Starting extra database worker thread " << threadId;
+    } else {
+        log() << "Starting new database worker thread " << threadId << " for queue " << queueId;
+        if (!_workerCpus.empty())
+            pinCurrentThread(_workerCpus[queueId % _workerCpus.size()]);
+    }
+
+    currentExecutor = this;
+    currentQueueId = queueId;
+
+    const auto guard = MakeGuard([this, isExtraWorker, it] {
+        currentExecutor = nullptr;
+        _threadsRunning.subtractAndFetch(1);
+        if (isExtraWorker)
+            _extraThreadsRunning.subtractAndFetch(1);
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+            it->detach();
+            _threads.erase(it);
+        }
+        _deathCondition.notify_one();
+    });
+
+    int tasksSinceNetworkPoll = 0;
+    while (_isRunning.load()) {
+        try {
+            asio::io_context::work work(*_ioContext);
+
+            Task task;
+            if (_popTask(queueId, &task) || _stealTask(queueId, &task)) {
+                _runTask(std::move(task));
+
+                // Network completions are only serviced by workers waiting on the io_context, so
+                // workers which never run out of tasks must check for them once in a while.
+                if (++tasksSinceNetworkPoll >= kTasksBetweenNetworkPolls) {
+                    tasksSinceNetworkPoll = 0;
+                    _ioContext->poll();
+                }
+                continue;
+            }
+
+            // Announce that this worker is idle before checking for tasks one last time, so that
+            // either this check sees a newly scheduled task, or its scheduler sees this worker as
+            // idle and wakes it up through the io_context.
+            _workersIdle.addAndFetch(1);
+            const auto idleGuard = MakeGuard([this] { _workersIdle.subtractAndFetch(1); });
+            if (_tasksPending.load() > 0)
+                continue;
+
+            tasksSinceNetworkPoll = 0;
+            auto handlersRun =
+                _ioContext->run_one_for(_config->idlePollInterval().toSystemDuration());
+
+            // run_one_for() returns immediately once the io_context has been stopped, restart it
+            // so we don't spin until the executor is shutdown.
+            if (_ioContext->stopped() && _isRunning.load())
+                _ioContext->restart();
+
+            if (isExtraWorker && handlersRun == 0 && _tasksPending.load() == 0) {
+                log() << "Extra worker thread was idle for the past "
+                      << _config->idlePollInterval() << ". Exiting thread.";
+                break;
+            }
+            // If an exception escaped from a task or from ASIO, then break from this thread and
+            // start a new one for the same queue.
+        } catch (std::exception& e) {
+            log() << "Exception escaped worker thread: " << e.what()
+                  << " Starting new worker thread.";
+            _startWorkerThread(queueId);
+            break;
+        } catch (...) {
+            log() << "Unknown exception escaped worker thread. Starting new worker thread.";
+            _startWorkerThread(queueId);
+            break;
+        }
+    }
+}
+
+void ServiceExecutorWorkStealing::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << kExecutorLabel << kExecutorName  //
+            << kTotalScheduled << _totalScheduled.load() << kTotalExecuted << _totalExecuted.load()
+            << kTotalStolen << _totalStolen.load() << kQueueDepth << _tasksPending.load()
+            << kTasksExecuting << _tasksExecuting.load() << kThreadsRunning
+            << _threadsRunning.load() << kExtraThreadsRunning << _extraThreadsRunning.load();
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/list.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/util/duration.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+
+/**
+ * This is an ASIO-based ServiceExecutor with a fixed set of worker threads, each of which owns a
+ * task queue. Tasks scheduled from a worker thread go onto that worker's queue, so a session's
+ * continuations tend to stay on the same thread, and workers which run out of tasks steal from the
+ * queues of other workers, starting with their neighbours. Workers without any queued tasks service
+ * network I/O on the shared io_context.
+ *
+ * Workers are only added beyond the fixed set when queued tasks make no progress for the stuck
+ * thread timeout, which means every worker is blocked in a long running task. Those extra workers
+ * exit again once they find nothing to do.
+ */
+class ServiceExecutorWorkStealing : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+        // The number of worker threads which own a task queue.
+        virtual int workerThreads() const = 0;
+
+        // Whether to pin each worker thread to its own CPU, in the order of the CPUs the process
+        // may run on. This is plain CPU pinning: the NUMA topology is not consulted.
+        virtual bool pinWorkerThreads() const = 0;
+
+        // The amount of time queued tasks may go without any worker picking one of them up before
+        // an extra worker is started to guarantee forward progress.
+        virtual Milliseconds stuckThreadTimeout() const = 0;
+
+        // The maximum amount of time an idle worker blocks waiting for network I/O before checking
+        // the task queues again.
+        virtual Milliseconds idlePollInterval() const = 0;
+    };
+
+    explicit ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                         std::shared_ptr<asio::io_context> ioCtx);
+    explicit ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                         std::shared_ptr<asio::io_context> ioCtx,
+                                         std::unique_ptr<Options> config);
+
+    virtual ~ServiceExecutorWorkStealing();
+
+    Status start() final;
+    Status shutdown() final;
+    Status schedule(Task task, ScheduleFlags flags) final;
+
+    void appendStats(BSONObjBuilder* bob) const final;
+
+    int threadsRunning() const {
+        return _threadsRunning.load();
+    }
+
+private:
+    using ThreadList = stdx::list<stdx::thread>;
+
+    // Any thread may push tasks to the back of a worker's queue: the worker itself, or schedulers
+    // from outside the worker threads via _nextQueue. The owning worker and the workers stealing
+    // from it both take tasks from the front, so queued tasks run in the order they were
+    // scheduled and a thief always takes the task which has waited the longest. The mutex is only
+    // held to push or pop a single task.
+    struct WorkerQueue {
+        stdx::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Marks extra workers, which do not own a queue and only steal.
+    static constexpr size_t kNoQueue = static_cast<size_t>(-1);
+
+    bool _popTask(size_t queueId, Task* task);
+    bool _stealTask(size_t queueId, Task* task);
+    void _runTask(Task task);
+
+    void _startWorkerThread(size_t queueId);
+    void _workerThreadRoutine(size_t queueId, int threadId, ThreadList::iterator it);
+    void _controllerThreadRoutine();
+
+    std::shared_ptr<asio::io_context> _ioContext;
+
+    std::unique_ptr<Options> _config;
+
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+
+    // CPUs to bind the workers to, empty unless pinWorkerThreads() is set.
+    std::vector<int> _workerCpus;
+
+    stdx::mutex _threadsMutex;
+    ThreadList _threads;
+    stdx::thread _controllerThread;
+
+    AtomicWord<bool> _isRunning{false};
+
+    // Used to distribute tasks scheduled from outside of the worker threads.
+    AtomicWord<unsigned> _nextQueue{0};
+
+    // Number of workers which found no queued tasks and wait for network I/O. Schedulers wake
+    // one of them up by posting an empty handler to the io_context.
+    AtomicWord<int> _workersIdle{0};
+
+    AtomicWord<int> _threadsRunning{0};
+    AtomicWord<int> _extraThreadsRunning{0};
+    AtomicWord<int> _tasksPending{0};
+    AtomicWord<int> _tasksExecuting{0};
+
+    // These counters are only used for stuck detection and for reporting in serverStatus.
+    AtomicWord<int64_t> _totalScheduled{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+    AtomicWord<int64_t> _totalStolen{0};
+
+    // Threads signal this condition variable when they exit so we can gracefully shutdown
+    // the executor.
+    stdx::condition_variable _deathCondition;
+
+    // Signalled on shutdown to stop the controller thread.
+    stdx::mutex _controllerMutex;
+    stdx::condition_variable _controllerCondition;
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,255 @@
+/**
+  *    Copyright (C) 2017 MongoDB Inc.
+  *
+  *    This program is free software: you can redistribute it and/or  modify
+  *    it under the terms of the GNU Affero General Public License, version 3,
+  *    as published by the Free Software Foundation.
+  *
+  *    This program is distributed in the hope that it will be useful,
+  *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *    GNU Affero General Public License for more details.
+  *
+  *    You should have received a copy of the GNU Affero General Public License
+  *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+  *
+  *    As a special exception, the copyright holders give permission to link the
+  *    code of portions of this program with the OpenSSL library under certain
+  *    conditions as described in each individual source file and distribute
+  *    linked combinations including the program with the OpenSSL library. You
+  *    must comply with the GNU Affero General Public License in all respects for
+  *    all of the code used other than as permitted herein. If you modify file(s)
+  *    with this exception, you may extend this exception to your version of the
+  *    file(s), but you are not obligated to do so. If you do not wish to do so,
+  *    delete this exception statement from your version. If you delete this
+  *    exception statement from all source files in the program, then also delete
+  *    it in the license file.
+  */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault;
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/service_context_noop.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor_work_stealing.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace {
+using namespace transport;
+
+struct TestOptions : public ServiceExecutorWorkStealing::Options {
+    int workerThreads() const final {
+        return 2;
+    }
+
+    bool pinWorkerThreads() const final {
+        return false;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return stuckTimeout;
+    }
+
+    Milliseconds idlePollInterval() const final {
+        return Milliseconds{50};
+    }
+
+    // Tests which must not see extra worker threads make this long enough that the controller
+    // never starts any.
+    Milliseconds stuckTimeout{100};
+};
+
+class ServiceExecutorWorkStealingFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = stdx::make_unique<ServiceContextNoop>();
+        setGlobalServiceContext(std::move(scOwned));
+        asioIoCtx = std::make_shared<asio::io_context>();
+    }
+
+    std::shared_ptr<asio::io_context> asioIoCtx;
+
+    stdx::mutex mutex;
+    int waitFor = -1;
+    stdx::condition_variable cond;
+    stdx::function<void()> notifyCallback = [this] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        invariant(waitFor != -1);
+        waitFor--;
+        cond.notify_one();
+        log() << "Ran callback";
+    };
+
+    void waitForCallback(int expected) {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        invariant(waitFor != -1);
+        cond.wait(lk, [&] { return waitFor == expected; });
+    }
+
+    long long getStat(ServiceExecutorWorkStealing* exec, StringData name) {
+        BSONObjBuilder bob;
+        exec->appendStats(&bob);
+        auto stats = bob.obj()["serviceExecutorTaskStats"].Obj();
+        ASSERT_EQ(stats["executor"].str(), "workStealing");
+        return stats[name].numberLong();
+    }
+
+    // Waits until all the extra worker threads have exited.
+    void waitForExtraThreadsToExit(ServiceExecutorWorkStealing* exec) {
+        const auto deadline = Date_t::now() + Seconds{30};
+        while (exec->threadsRunning() > config->workerThreads()) {
+            ASSERT_LT(Date_t::now(), deadline);
+            stdx::this_thread::sleep_for(config->idlePollInterval().toSystemDuration());
+        }
+    }
+
+    ServiceExecutorWorkStealing::Options* config;
+    std::unique_ptr<ServiceExecutorWorkStealing> makeAndStartExecutor(
+        Milliseconds stuckTimeout = Milliseconds{100}) {
+        auto configOwned = stdx::make_unique<TestOptions>();
+        configOwned->stuckTimeout = stuckTimeout;
+        config = configOwned.get();
+        auto exec = stdx::make_unique<ServiceExecutorWorkStealing>(
+            getGlobalServiceContext(), asioIoCtx, std::move(configOwned));
+
+        ASSERT_OK(exec->start());
+        log() << "wait for executor to finish starting";
+        waitFor = 1;
+        ASSERT_OK(exec->schedule(notifyCallback, ServiceExecutor::EmptyFlags));
+        waitForCallback(0);
+        ASSERT_EQ(exec->threadsRunning(), config->workerThreads());
+
+        return exec;
+    }
+};
+
+/*
+ * This tests that tasks scheduled from within running tasks, deferred or not, all get run.
+ */
+TEST_F(ServiceExecutorWorkStealingFixture, TestTasksScheduledFromTasks) {
+    auto exec = makeAndStartExecutor();
+    auto guard = MakeGuard([&] { ASSERT_OK(exec->shutdown()); });
+
+    waitFor = 100;
+    stdx::function<void(int)> scheduleChain = [&](int remaining) {
+        notifyCallback();
+        if (remaining == 1)
+            return;
+        auto flags = (remaining % 2) ? ServiceExecutor::DeferredTask : ServiceExecutor::EmptyFlags;
+        ASSERT_OK(exec->schedule([&, remaining] { scheduleChain(remaining - 1); }, flags));
+    };
+
+    log() << "Scheduling chain of " << waitFor << " tasks";
+    ASSERT_OK(exec->schedule([&] { scheduleChain(100); }, ServiceExecutor::EmptyFlags));
+    waitForCallback(0);
+    ASSERT_EQ(exec->threadsRunning(), config->workerThreads());
+}
+
+/*
+ * This tests that tasks queued behind a blocked task on one worker's queue get stolen by another
+ * worker, oldest first.
+ */
+TEST_F(ServiceExecutorWorkStealingFixture, TestStealFromBlockedWorker) {
+    stdx::mutex blockedMutex;
+    stdx::unique_lock<stdx::mutex> blockedLock(blockedMutex);
+
+    // Only stealing can run the queued tasks, the controller never starts extra workers.
+    auto exec = makeAndStartExecutor(Hours{1});
+    auto guard = MakeGuard([&] {
+        if (blockedLock)
+            blockedLock.unlock();
+        ASSERT_OK(exec->shutdown());
+    });
+
+    std::vector<int> stolenOrder;
+    auto makeQueuedTask = [this, &stolenOrder](int id) {
+        return [this, &stolenOrder, id] {
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                stolenOrder.push_back(id);
+            }
+            notifyCallback();
+        };
+    };
+
+    log() << "Scheduling blocked task which queues two tasks behind itself";
+    waitFor = 3;
+    ASSERT_OK(exec->schedule(
+        [&] {
+            ASSERT_OK(exec->schedule(makeQueuedTask(1), ServiceExecutor::EmptyFlags));
+            ASSERT_OK(exec->schedule(makeQueuedTask(2), ServiceExecutor::EmptyFlags));
+            stdx::unique_lock<stdx::mutex> lk(blockedMutex);
+            notifyCallback();
+        },
+        ServiceExecutor::EmptyFlags));
+
+    log() << "Waiting for queued tasks to be stolen";
+    waitForCallback(1);
+    ASSERT_GTE(getStat(exec.get(), "totalStolen"), 2);
+    ASSERT_EQ(exec->threadsRunning(), config->workerThreads());
+    {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        ASSERT_EQ(stolenOrder.size(), 2U);
+        ASSERT_EQ(stolenOrder[0], 1);
+        ASSERT_EQ(stolenOrder[1], 2);
+    }
+
+    blockedLock.unlock();
+    waitForCallback(0);
+}
+
+/*
+ * This tests that the executor will start extra threads if all the workers are blocked with
+ * tasks still queued, and that those threads retire when they become idle.
+ */
+TEST_F(ServiceExecutorWorkStealingFixture, TestStuckThreads) {
+    stdx::mutex blockedMutex;
+    stdx::unique_lock<stdx::mutex> blockedLock(blockedMutex);
+
+    auto exec = makeAndStartExecutor();
+    auto guard = MakeGuard([&] {
+        if (blockedLock)
+            blockedLock.unlock();
+        ASSERT_OK(exec->shutdown());
+    });
+
+    auto blockedTask = [this, &blockedMutex] {
+        log() << "waiting on blocked mutex";
+        notifyCallback();
+        stdx::unique_lock<stdx::mutex> lk(blockedMutex);
+        notifyCallback();
+    };
+
+    const int numBlocked = config->workerThreads();
+    waitFor = numBlocked * 2 + 1;
+    log() << "Scheduling " << numBlocked << " blocked tasks";
+    for (auto i = 0; i < numBlocked; i++) {
+        ASSERT_OK(exec->schedule(blockedTask, ServiceExecutor::EmptyFlags));
+    }
+    waitForCallback(numBlocked + 1);
+
+    log() << "Scheduling task stuck behind the blocked workers";
+    ASSERT_OK(exec->schedule(notifyCallback, ServiceExecutor::EmptyFlags));
+    waitForCallback(numBlocked);
+    ASSERT_GT(exec->threadsRunning(), config->workerThreads());
+
+    log() << "Waiting for blocked tasks to run";
+    blockedLock.unlock();
+    waitForCallback(0);
+
+    log() << "Waiting for extra threads to idle out";
+    waitForExtraThreadsToExit(exec.get());
+    ASSERT_EQ(exec->threadsRunning(), config->workerThreads());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,59 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+/**
+ * Returns the CPU the calling thread runs on where the OS makes that cheap to find out, and
+ * otherwise an index assigned to the calling thread on first use. Callers use this to spread
+ * per-process state across partitions that threads on different CPUs rarely share.
+ *
+ * The result is only a hint: the thread may migrate to another CPU at any time, so state chosen
+ * with it must still be safe to use from any thread.
+ */
+inline unsigned currentCPUOrThreadIndex() {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return static_cast<unsigned>(cpu);
+    }
+#endif
+    static AtomicUInt32 nextThreadIndex;
+    thread_local const unsigned threadIndex = nextThreadIndex.fetchAndAdd(1);
+    return threadIndex;
+}
+
+}  // namespace mongo